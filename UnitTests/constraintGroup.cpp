@@ -0,0 +1,49 @@
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<unistd.h>
+#include<sys/stat.h>
+
+/* test executable for the constraint groups, compiled as constraintGroupA and constraintGroupB:
+ * writes x1+x2 to constraintGroup1.dat and x1-x2 to constraintGroup2.dat (plus 100 for constraintGroupB),
+ * appends a line to the file CONSTRAINT_GROUP_RUNS for each run and creates constraintGroupOverlap.dat
+ * if another run is active in the same directory */
+
+int main(int argc, char *argv[]){
+
+double x[2];
+FILE *inp = fopen("dv.dat","r");
+fscanf(inp,"%lf",&x[0]);
+fscanf(inp,"%lf",&x[1]);
+fclose(inp);
+
+double offset = 0.0;
+if(argv[0][strlen(argv[0])-1] == 'B') offset = 100.0;
+
+if(mkdir("constraintGroupRunning", 0755) != 0){
+
+	FILE *overlap = fopen("constraintGroupOverlap.dat","w");
+	fclose(overlap);
+}
+
+const char *filenameRuns = getenv("CONSTRAINT_GROUP_RUNS");
+if(filenameRuns == NULL) filenameRuns = "constraintGroupRuns.dat";
+
+FILE *runs = fopen(filenameRuns,"a");
+fprintf(runs,"%s\n",argv[0]);
+fclose(runs);
+
+usleep(500000);
+
+FILE *outp = fopen("constraintGroup1.dat","w");
+fprintf(outp,"%15.10f\n",x[0]+x[1]+offset);
+fclose(outp);
+
+outp = fopen("constraintGroup2.dat","w");
+fprintf(outp,"%15.10f\n",x[0]-x[1]+offset);
+fclose(outp);
+
+rmdir("constraintGroupRunning");
+
+return 0;
+}
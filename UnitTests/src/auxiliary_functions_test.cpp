@@ -32,6 +32,8 @@
 #include "auxiliary_functions.hpp"
 #include "test_defines.hpp"
 #include<gtest/gtest.h>
+#include<omp.h>
+#include<fstream>
 
 #ifdef TEST_AUX
 
@@ -295,5 +297,106 @@ TEST(testAuxiliaryFunctions, isEqualString){
 
 }
 
+TEST(testAuxiliaryFunctions, setRandomSeed){
+
+	vec lb(3, fill::zeros);
+	vec ub(3, fill::ones);
+	ub(2) = 5.0;
+
+	setRandomSeed(12345);
+	mat X1 = generateRandomMatrix(50, lb, ub);
+	double r1 = generateRandomDouble(0.0, 1.0);
+
+	setRandomSeed(12345);
+	mat X2 = generateRandomMatrix(50, lb, ub);
+	double r2 = generateRandomDouble(0.0, 1.0);
+
+	ASSERT_TRUE(approx_equal(X1, X2, "absdiff", 0.0));
+	ASSERT_EQ(r1, r2);
+
+	ASSERT_TRUE(X1.min() >= 0.0);
+	ASSERT_TRUE(X1.col(2).max() < 5.0);
+	ASSERT_TRUE(X1.col(0).max() < 1.0);
+
+}
+
+TEST(testAuxiliaryFunctions, setRandomSeedStreamsDoNotDependOnCallOrder){
+
+	const int numberOfThreads = 4;
+	vec r1(numberOfThreads, fill::zeros);
+	vec r2(numberOfThreads, fill::zeros);
+
+	/* first run: the threads draw in increasing order of their thread numbers, second run: in decreasing order */
+
+	setRandomSeed(12345);
+
+#pragma omp parallel num_threads(numberOfThreads)
+	{
+		for(int k=0; k<omp_get_num_threads(); k++){
+
+			if(omp_get_thread_num() == k) r1(k) = generateRandomDouble(0.0, 1.0);
+#pragma omp barrier
+		}
+	}
+
+	setRandomSeed(12345);
+
+#pragma omp parallel num_threads(numberOfThreads)
+	{
+		for(int k=omp_get_num_threads()-1; k>=0; k--){
+
+			if(omp_get_thread_num() == k) r2(k) = generateRandomDouble(0.0, 1.0);
+#pragma omp barrier
+		}
+	}
+
+	ASSERT_TRUE(approx_equal(r1, r2, "absdiff", 0.0));
+
+}
+
+TEST(testAuxiliaryFunctions, quoteForShell){
+
+	ASSERT_EQ(quoteForShell("simulation"), "'simulation'");
+	ASSERT_EQ(quoteForShell("/home/my dir/run;rm"), "'/home/my dir/run;rm'");
+	ASSERT_EQ(quoteForShell("it's"), "'it'\\''s'");
+
+}
+
+TEST(testAuxiliaryFunctions, createAndRemoveDirectory){
+
+	std::string directory = "testDirectoryForCreateDirectory";
+
+	removeDirectory(directory);
+	ASSERT_FALSE(directory_exist(directory));
+
+	ASSERT_TRUE(createDirectory(directory));
+	ASSERT_TRUE(directory_exist(directory));
+	ASSERT_TRUE(createDirectory(directory));
+
+	std::string absolutePath = getAbsolutePath(directory);
+	ASSERT_EQ(absolutePath[0], '/');
+	ASSERT_TRUE(directory_exist(absolutePath));
+
+	removeDirectory(directory);
+	ASSERT_FALSE(directory_exist(directory));
+
+}
+
+TEST(testAuxiliaryFunctions, removeDirectoryWithContentsAndQuoteInName){
+
+	std::string directory = "testDirectory'WithQuote";
+
+	ASSERT_TRUE(createDirectory(directory));
+	ASSERT_TRUE(createDirectory(directory + "/subdirectory"));
+
+	std::ofstream file(directory + "/subdirectory/file.csv");
+	file << "1.0\n";
+	file.close();
+
+	removeDirectory(directory);
+	ASSERT_FALSE(directory_exist(directory));
+
+}
+
 #endif
 
@@ -0,0 +1,131 @@
+/*
+ * RoDeO, a Robust Design Optimization Package
+ *
+ * Copyright (C) 2015-2023 Chair for Scientific Computing (SciComp), RPTU
+ * Homepage: http://www.scicomp.uni-kl.de
+ * Contact:  Prof. Nicolas R. Gauger (nicolas.gauger@scicomp.uni-kl.de) or Dr. Emre Özkaya (emre.oezkaya@scicomp.uni-kl.de)
+ *
+ * Lead developer: Emre Özkaya (SciComp, RPTU)
+ *
+ * This file is part of RoDeO
+ *
+ * RoDeO is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * RoDeO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details.
+ * You should have received a copy of the GNU
+ * General Public License along with RoDeO.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors: Emre Özkaya, (SciComp, RPTU)
+ *
+ *
+ *
+ */
+
+#include<gtest/gtest.h>
+#include "binary_data_file.hpp"
+#include "surrogate_model_data.hpp"
+#include "matrix_vector_operations.hpp"
+#include "test_defines.hpp"
+#include<cstdio>
+
+#ifdef TEST_BINARY_DATA_FILE
+
+class BinaryDataFileTest : public ::testing::Test {
+protected:
+	void SetUp() override {
+
+		remove("testBinaryData.bin");
+	}
+
+	void TearDown() override {
+
+		remove("testBinaryData.bin");
+		remove("testBinaryData.csv");
+	}
+
+};
+
+TEST_F(BinaryDataFileTest, writeAndRead){
+
+	mat data(100, 5, fill::randu);
+
+	BinaryDataFile dataFile("testBinaryData.bin");
+	dataFile.setBoxConstraints(Bounds(zeros<vec>(4), ones<vec>(4)));
+	dataFile.write(data);
+
+	ASSERT_TRUE(BinaryDataFile::checkIfBinaryDataFile("testBinaryData.bin"));
+
+	BinaryDataFile dataFileRead("testBinaryData.bin");
+	mat dataRead = dataFileRead.read();
+
+	ASSERT_EQ(dataFileRead.getDimension(), 4);
+	ASSERT_TRUE(dataFileRead.getBoxConstraints().areBoundsSet());
+	ASSERT_TRUE(approx_equal(data, dataRead, "absdiff", 0.0));
+
+}
+
+TEST_F(BinaryDataFileTest, appendRowsBeyondTheCapacity){
+
+	mat data(BinaryDataFile::minimumCapacity, 3, fill::randu);
+
+	BinaryDataFile dataFile("testBinaryData.bin");
+	dataFile.write(data);
+
+	rowvec newSample(3, fill::randu);
+	appendRowVectorToCSVData(newSample, "testBinaryData.bin");
+
+	mat dataRead = readMatFromCVSFile("testBinaryData.bin");
+
+	ASSERT_EQ(dataRead.n_rows, data.n_rows + 1);
+	ASSERT_TRUE(approx_equal(dataRead.row(data.n_rows), newSample, "absdiff", 0.0));
+
+	appendRowVectorToCSVData(newSample, "testBinaryData.bin");
+
+	BinaryDataFile dataFileRead("testBinaryData.bin");
+	dataFileRead.readHeader();
+	ASSERT_EQ(dataFileRead.getNumberOfRows(), data.n_rows + 2);
+	ASSERT_GT(dataFileRead.getCapacity(), data.n_rows + 2);
+
+}
+
+TEST_F(BinaryDataFileTest, readDataWithGradients){
+
+	mat data(20, 7, fill::randu);
+
+	BinaryDataFile dataFile("testBinaryData.bin");
+	dataFile.setGradientsOn();
+	dataFile.write(data);
+
+	SurrogateModelData testData;
+	testData.setGradientsOn();
+	testData.readData("testBinaryData.bin");
+
+	ASSERT_EQ(testData.getDimension(), 3);
+	ASSERT_EQ(testData.getNumberOfSamples(), 20);
+
+}
+
+TEST_F(BinaryDataFileTest, exportToCSV){
+
+	mat data(10, 4, fill::randu);
+
+	BinaryDataFile dataFile("testBinaryData.bin");
+	dataFile.write(data);
+	dataFile.exportToCSV("testBinaryData.csv");
+
+	mat dataRead;
+	dataRead.load("testBinaryData.csv", csv_ascii);
+
+	ASSERT_TRUE(approx_equal(data, dataRead, "absdiff", 0.0));
+
+}
+
+#endif
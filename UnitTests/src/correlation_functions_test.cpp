@@ -114,6 +114,75 @@ TEST_F(CorrelationFunctionsTest, testcomputeCorrelationMatrix){
 
 }
 
+TEST_F(CorrelationFunctionsTest, testcomputeCorrelationMatrixWithSeveralTiles){
+
+	unsigned int N = 150;
+	unsigned dim = 3;
+	mat testInput(N,dim,fill::randu);
+
+	vec theta(dim); theta.fill(2.0);
+	vec gamma(dim); gamma.fill(1.5);
+
+	testCorrelationFunction.setTheta(theta);
+	testCorrelationFunction.setGamma(gamma);
+	testCorrelationFunction.setInputSampleMatrix(testInput);
+	testCorrelationFunction.computeCorrelationMatrix();
+
+	mat R = testCorrelationFunction.getCorrelationMatrix();
+
+	ASSERT_TRUE(R.is_symmetric());
+
+	double error = fabs(R(3,140) - testCorrelationFunction.computeCorrelation(testInput.row(3), testInput.row(140)));
+	EXPECT_LT(error, 10E-10);
+
+	vec r = testCorrelationFunction.computeCorrelationVector(testInput.row(7));
+	error = fabs(r(100) - R(7,100));
+	EXPECT_LT(error, 10E-10);
+
+}
+
+TEST_F(CorrelationFunctionsTest, testcomputeCorrelationMatrixWithDistanceCache){
+
+	unsigned int N = 100;
+	unsigned dim = 4;
+	mat testInput(N,dim,fill::randu);
+	testInput.row(10) = testInput.row(20);
+
+	vec theta(dim); theta.fill(1.0);
+	vec gamma(dim); gamma.fill(1.8);
+	gamma(0) = 0.0;
+
+	testCorrelationFunction.setTheta(theta);
+	testCorrelationFunction.setGamma(gamma);
+	testCorrelationFunction.setInputSampleMatrix(testInput);
+	testCorrelationFunction.computeCorrelationMatrix();
+
+	mat R = testCorrelationFunction.getCorrelationMatrix();
+
+	testCorrelationFunction.buildDistanceCache();
+	ASSERT_TRUE(testCorrelationFunction.isDistanceCacheBuilt());
+
+	testCorrelationFunction.computeCorrelationMatrix();
+	mat Rcached = testCorrelationFunction.getCorrelationMatrix();
+
+	mat error = R - Rcached;
+	EXPECT_TRUE(error.is_zero(10E-10));
+
+	/* a copy shares the cache and can still use it after the original has released it */
+	ExponentialCorrelationFunction copyOfCorrelationFunction = testCorrelationFunction;
+	testCorrelationFunction.clearDistanceCache();
+	ASSERT_TRUE(copyOfCorrelationFunction.isDistanceCacheBuilt());
+
+	copyOfCorrelationFunction.computeCorrelationMatrix();
+	error = R - copyOfCorrelationFunction.getCorrelationMatrix();
+	EXPECT_TRUE(error.is_zero(10E-10));
+
+	testCorrelationFunction.setMaximumMemoryForDistanceCache(0.0);
+	testCorrelationFunction.buildDistanceCache();
+	ASSERT_FALSE(testCorrelationFunction.isDistanceCacheBuilt());
+
+}
+
 TEST_F(CorrelationFunctionsTest, testcomputeCorrelationMatrixBiQuadSpline){
 
 	unsigned int N = 10;
@@ -173,9 +242,36 @@ TEST_F(CorrelationFunctionsTest, testcomputeCorrelationMatrixDot){
 	testCorrelationFunctionGEK.setInputSampleMatrix(testInput);
 	testCorrelationFunctionGEK.computeCorrelationMatrixDot();
 
+	mat Rdot = testCorrelationFunctionGEK.getCorrelationMatrixDot();
+
+	ASSERT_EQ(Rdot.n_rows, N*(dim+1));
+	ASSERT_EQ(Rdot.n_cols, N*(dim+1));
 
+	/* entries of the dR/dxi block, computed one by one */
+	mat dRdx0 = testCorrelationFunctionGEK.compute_dCorrelationMatrixdxi(0);
+	ASSERT_TRUE(isEqual(mat(Rdot.submat(N, 0, 2*N-1, N-1)), dRdx0, 10E-10));
 
+}
+
+/* more samples than a tile, the blocks of the pairs in different tiles must agree with the reference implementation */
+
+TEST_F(CorrelationFunctionsTest, testcomputeCorrelationMatrixDotWithManySamples){
+
+	unsigned int N = 70;
+	unsigned dim = 3;
+	mat testInput = generateDataMatrixForTestingCorrelationFunctions(N,dim);
+
+	vec theta(dim, fill::randu);
+	testCorrelationFunctionGEK.setHyperParameters(theta);
+	testCorrelationFunctionGEK.setInputSampleMatrix(testInput);
+
+	testCorrelationFunctionGEK.computeCorrelationMatrixDotForrester();
+	mat RdotReference = testCorrelationFunctionGEK.getCorrelationMatrixDot();
+
+	testCorrelationFunctionGEK.computeCorrelationMatrixDot();
+	mat Rdot = testCorrelationFunctionGEK.getCorrelationMatrixDot();
 
+	ASSERT_TRUE(isEqual(Rdot, RdotReference, 10E-8));
 
 }
 
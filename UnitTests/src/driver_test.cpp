@@ -289,6 +289,29 @@ TEST(testDriver, readConfigFile){
 
 }
 
+TEST(testDriver, readConfigFileSetsRandomSeed){
+
+	setRandomSeed(1);
+
+	RoDeODriver testDriver;
+	testDriver.setConfigFilename("testConfigFileRandomSeed.cfg");
+	testDriver.readConfigFile();
+
+	ASSERT_EQ(getRandomSeed(), 12345ULL);
+
+}
+
+TEST(testDriver, readConfigFileGradientBasedModelTraining){
+
+	RoDeODriver testDriver;
+	testDriver.setConfigFilename("testConfigFileGradientBasedModelTraining.cfg");
+	testDriver.readConfigFile();
+
+	ObjectiveFunctionDefinition objFun = testDriver.getObjectiveFunctionDefinition();
+	EXPECT_TRUE(objFun.ifGradientBasedModelTraining);
+
+}
+
 TEST(testDriver, testreadConfigFile2){
 	RoDeODriver testDriver;
 	testDriver.setConfigFilename("testConfigFile2.cfg");
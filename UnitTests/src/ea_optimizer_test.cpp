@@ -35,6 +35,10 @@
 #include "auxiliary_functions.hpp"
 #include "test_defines.hpp"
 #include<gtest/gtest.h>
+#include<algorithm>
+#include<atomic>
+#include<omp.h>
+#include<unistd.h>
 
 
 #ifdef  TESTEAOPTIMIZER
@@ -331,6 +335,55 @@ TEST_F(EAPopulationTest, testpickUpAnIndividualThatWillDie){
 
 }
 
+TEST_F(EAPopulationTest, testpickUpIndividualsThatWillDie){
+
+	addSomeInvididualsToTestPopulation(20);
+
+	testPopulation.updatePopulationProperties();
+
+	std::vector<unsigned int> orders = testPopulation.pickUpIndividualsThatWillDie(19);
+
+	ASSERT_TRUE(orders.size() == 19);
+
+	std::sort(orders.begin(), orders.end());
+
+	for(unsigned int i=1; i<orders.size(); i++){
+
+		ASSERT_TRUE(orders[i] != orders[i-1]);
+	}
+
+	/* the best individual (order 0) never dies */
+	ASSERT_TRUE(orders[0] == 1);
+
+}
+
+TEST_F(EAPopulationTest, testremoveIndividuals){
+
+	addSomeInvididualsToTestPopulation(10);
+
+	std::vector<unsigned int> orders = {9, 0, 4};
+	testPopulation.removeIndividuals(orders);
+
+	ASSERT_TRUE(testPopulation.getSize() == 7);
+	ASSERT_TRUE(testPopulation.getIndividualOrderInPopulationById(0) == -1);
+	ASSERT_TRUE(testPopulation.getIndividualOrderInPopulationById(4) == -1);
+	ASSERT_TRUE(testPopulation.getIndividualOrderInPopulationById(9) == -1);
+
+	for(unsigned int id=1; id<9; id++){
+
+		if(id == 4) continue;
+
+		int order = testPopulation.getIndividualOrderInPopulationById(id);
+		ASSERT_TRUE(testPopulation.getIdOftheIndividual(order) == id);
+	}
+
+	EAIndividual min = testPopulation.getTheBestIndividual();
+	ASSERT_TRUE(min.getId() == 1);
+
+	EAIndividual max = testPopulation.getTheWorstIndividual();
+	ASSERT_TRUE(max.getId() == 8);
+
+}
 
 
 
@@ -433,6 +486,70 @@ TEST_F(EAOptimizerTest, testinitializePopulationParallel){
 
 
 
+/* Eggholder function that also records the threads it is called from */
+static std::atomic<unsigned int> threadsCallingTheObjectiveFunction(0);
+
+static double EggholderRecordingTheThreads(vec x){
+
+	threadsCallingTheObjectiveFunction |= (1U << (omp_get_thread_num() % 32));
+	usleep(1000);
+
+	return Eggholder(x);
+}
+
+TEST_F(EAOptimizerTest, testcallObjectiveFunctionForAGroupWithMoreThreads){
+
+	threadsCallingTheObjectiveFunction = 0;
+
+	testOptimizer.setObjectiveFunction(EggholderRecordingTheThreads);
+	testOptimizer.setNumberOfThreads(4);
+	ASSERT_EQ(testOptimizer.getNumberOfThreadsForEvaluation(), 4U);
+
+	testOptimizer.setInitialPopulationSize(100);
+	testOptimizer.initializePopulation();
+
+	ASSERT_TRUE(testOptimizer.getPopulationSize() == 100);
+
+	/* more than one thread has evaluated the objective function */
+	unsigned int threadMask = threadsCallingTheObjectiveFunction.load();
+	ASSERT_TRUE((threadMask & (threadMask - 1)) != 0);
+
+	/* the values must be the same as in a serial evaluation */
+	EAIndividual best = testOptimizer.getSolution();
+	EXPECT_EQ(best.getObjectiveFunctionValue(), Eggholder(best.getGenes()));
+
+}
+
+TEST_F(EAOptimizerTest, testgetNumberOfThreadsForEvaluation){
+
+	ASSERT_EQ(testOptimizer.getNumberOfThreadsForEvaluation(), (unsigned int) omp_get_num_procs());
+
+	testOptimizer.setNumberOfThreads(2);
+	ASSERT_EQ(testOptimizer.getNumberOfThreadsForEvaluation(), 2U);
+
+}
+
+TEST_F(EAOptimizerTest, testgetNumberOfThreadsForEvaluationInANestedRegion){
+
+	testOptimizer.setNumberOfThreads(2);
+
+	int maximumActiveLevels = omp_get_max_active_levels();
+	omp_set_max_active_levels(1);
+
+	unsigned int numberOfThreadsInTheRegion = 0;
+
+#pragma omp parallel num_threads(2)
+	{
+#pragma omp master
+		numberOfThreadsInTheRegion = testOptimizer.getNumberOfThreadsForEvaluation();
+	}
+
+	omp_set_max_active_levels(maximumActiveLevels);
+
+	ASSERT_EQ(numberOfThreadsInTheRegion, 1U);
+
+}
+
 TEST_F(EAOptimizerTest, testgenerateRandomParents){
 
 	unsigned int NRandomEvents = 10000;
@@ -752,6 +869,13 @@ TEST_F(EAOptimizerTestWithDerivedClass, testcalculateObjectiveFunctionInternal){
 }
 
 
+TEST_F(EAOptimizerTestWithDerivedClass, testObjectiveFunctionWithStateIsEvaluatedSerially){
+
+	testOptimizer.setNumberOfThreads(4);
+	ASSERT_EQ(testOptimizer.getNumberOfThreadsForEvaluation(), 1U);
+
+}
+
 TEST_F(EAOptimizerTestWithDerivedClass, testOptimizeWithDerivedClass){
 
 
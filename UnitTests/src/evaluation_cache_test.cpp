@@ -0,0 +1,95 @@
+/*
+ * RoDeO, a Robust Design Optimization Package
+ *
+ * Copyright (C) 2015-2023 Chair for Scientific Computing (SciComp), RPTU
+ * Homepage: http://www.scicomp.uni-kl.de
+ * Contact:  Prof. Nicolas R. Gauger (nicolas.gauger@scicomp.uni-kl.de) or Dr. Emre Özkaya (emre.oezkaya@scicomp.uni-kl.de)
+ *
+ * Lead developer: Emre Özkaya (SciComp, RPTU)
+ *
+ * This file is part of RoDeO
+ *
+ * RoDeO is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * RoDeO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details.
+ * You should have received a copy of the GNU
+ * General Public License along with RoDeO.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors: Emre Özkaya, (SciComp, RPTU)
+ *
+ *
+ *
+ */
+
+#include "evaluation_cache.hpp"
+#include "test_defines.hpp"
+#include<gtest/gtest.h>
+#include<cstdio>
+
+#ifdef TEST_EVALUATION_CACHE
+
+class EvaluationCacheTest : public ::testing::Test {
+protected:
+	void SetUp() override {
+
+		remove("testEvaluationCache.bin");
+	}
+
+	void TearDown() override {
+
+		remove("testEvaluationCache.bin");
+	}
+
+};
+
+TEST_F(EvaluationCacheTest, findAfterAdd){
+
+	EvaluationCache cache("testEvaluationCache.bin");
+
+	std::vector<double> x = {1.0, 2.5};
+	std::string key = EvaluationCache::generateKey("himmelblau", "primal", x);
+
+	std::vector<double> outputs;
+	ASSERT_FALSE(cache.find(key, outputs));
+
+	cache.add(key, std::vector<double>(1, 3.7));
+
+	/* a design that differs only by round-off has the same key */
+	std::vector<double> xPerturbed = {1.0 + 1E-15, 2.5};
+	ASSERT_TRUE(cache.find(EvaluationCache::generateKey("himmelblau", "primal", xPerturbed), outputs));
+	ASSERT_EQ(outputs.size(), 1);
+	EXPECT_EQ(outputs[0], 3.7);
+
+	ASSERT_FALSE(cache.find(EvaluationCache::generateKey("himmelblau", "adjoint", x), outputs));
+
+}
+
+TEST_F(EvaluationCacheTest, readEntriesFromFile){
+
+	std::vector<double> x = {0.1, -0.2, 0.3};
+	std::string key = EvaluationCache::generateKey("constraint1", "adjoint", x);
+	std::vector<double> values = {1.0, 2.0, 3.0, 4.0};
+
+	{
+		EvaluationCache cache("testEvaluationCache.bin");
+		cache.add(key, values);
+	}
+
+	EvaluationCache cache("testEvaluationCache.bin");
+	ASSERT_EQ(cache.getNumberOfEntriesReadFromFile(), 1);
+
+	std::vector<double> outputs;
+	ASSERT_TRUE(cache.find(key, outputs));
+	ASSERT_TRUE(outputs == values);
+
+}
+
+#endif
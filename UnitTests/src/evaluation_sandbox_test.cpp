@@ -0,0 +1,127 @@
+/*
+ * RoDeO, a Robust Design Optimization Package
+ *
+ * Copyright (C) 2015-2023 Chair for Scientific Computing (SciComp), RPTU
+ * Homepage: http://www.scicomp.uni-kl.de
+ * Contact:  Prof. Nicolas R. Gauger (nicolas.gauger@scicomp.uni-kl.de) or Dr. Emre Özkaya (emre.oezkaya@scicomp.uni-kl.de)
+ *
+ * Lead developer: Emre Özkaya (SciComp, RPTU)
+ *
+ * This file is part of RoDeO
+ *
+ * RoDeO is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * RoDeO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details.
+ * You should have received a copy of the GNU
+ * General Public License along with RoDeO.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors: Emre Özkaya, (SciComp, RPTU)
+ *
+ *
+ *
+ */
+
+#include "evaluation_sandbox.hpp"
+#include "auxiliary_functions.hpp"
+#include "test_defines.hpp"
+#include<gtest/gtest.h>
+#include<fstream>
+
+#ifdef TEST_EVALUATION_SANDBOX
+
+class EvaluationSandboxTest : public ::testing::Test {
+protected:
+	void SetUp() override {
+
+		removeDirectory("testSandbox");
+		removeDirectory("testSandboxTemplate");
+		removeDirectory("testSandboxArchive");
+
+		createDirectory("testSandboxTemplate");
+		std::ofstream templateFile("testSandboxTemplate/input.txt");
+		templateFile << "template\n";
+		templateFile.close();
+
+		sandbox.setRootDirectory("testSandbox");
+		sandbox.setTemplateDirectory("testSandboxTemplate");
+	}
+
+	void TearDown() override {
+
+		removeDirectory("testSandbox");
+		removeDirectory("testSandboxTemplate");
+		removeDirectory("testSandboxArchive");
+	}
+
+	EvaluationSandbox sandbox;
+
+};
+
+TEST_F(EvaluationSandboxTest, createJobDirectory){
+
+	std::string directory1 = sandbox.createJobDirectory("himmelblau");
+	std::string directory2 = sandbox.createJobDirectory("himmelblau");
+
+	ASSERT_NE(directory1, directory2);
+	ASSERT_TRUE(directory_exist(directory1));
+	ASSERT_TRUE(directory_exist(directory2));
+	ASSERT_TRUE(file_exist(directory1 + "/input.txt"));
+
+}
+
+TEST_F(EvaluationSandboxTest, finalizeJobDirectory){
+
+	std::string directory = sandbox.createJobDirectory("himmelblau");
+	sandbox.finalizeJobDirectory(directory);
+	ASSERT_FALSE(directory_exist(directory));
+
+	sandbox.setArchiveDirectory("testSandboxArchive");
+
+	directory = sandbox.createJobDirectory("himmelblau");
+	sandbox.finalizeJobDirectory(directory);
+	ASSERT_FALSE(directory_exist(directory));
+	ASSERT_TRUE(file_exist("testSandboxArchive/himmelblau_1/input.txt"));
+
+}
+
+/* quotes in the configured paths must not break the shell commands */
+
+TEST_F(EvaluationSandboxTest, pathsWithQuotes){
+
+	std::string templateDirectory = "testSandbox'Template";
+	std::string archiveDirectory  = "testSandbox'Archive";
+
+	removeDirectory(templateDirectory);
+	removeDirectory(archiveDirectory);
+
+	createDirectory(templateDirectory);
+	std::ofstream templateFile(templateDirectory + "/input.txt");
+	templateFile << "template\n";
+	templateFile.close();
+
+	sandbox.setRootDirectory("testSandbox'Root");
+	sandbox.setTemplateDirectory(templateDirectory);
+	sandbox.setArchiveDirectory(archiveDirectory);
+
+	std::string directory = sandbox.createJobDirectory("it's");
+	ASSERT_TRUE(file_exist(directory + "/input.txt"));
+
+	sandbox.finalizeJobDirectory(directory);
+	ASSERT_FALSE(directory_exist(directory));
+	ASSERT_TRUE(file_exist(archiveDirectory + "/it's_0/input.txt"));
+
+	removeDirectory("testSandbox'Root");
+	removeDirectory(templateDirectory);
+	removeDirectory(archiveDirectory);
+
+}
+
+#endif
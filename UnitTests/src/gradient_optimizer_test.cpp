@@ -182,5 +182,29 @@ TEST_F(GradientOptimizerTest, testOptimizeWithSteepestDescent) {
 }
 
 
+TEST_F(GradientOptimizerTest, testOptimizeWithBFGSUpdate) {
+
+
+	testOptimizer.setMaximumNumberOfFunctionEvaluations(200);
+	testOptimizer.setMaximumStepSize(1.0);
+	testOptimizer.setBFGSUpdateOn();
+
+	Bounds boxConstraints(2);
+	boxConstraints.setBounds(-6.0,6.0);
+
+	vec x0(2);
+	x0(0) = 1.7; x0(1) = 1.2;
+	testOptimizer.setInitialPoint(x0);
+
+	testOptimizer.setBounds(boxConstraints);
+	testOptimizer.optimize();
+
+	double J = testOptimizer.getOptimalObjectiveFunctionValue();
+
+	EXPECT_LT(J, 10E-06);
+	EXPECT_LE(testOptimizer.getNumberOfFunctionEvaluations(), 200u);
+
+}
+
 
 #endif
@@ -196,6 +196,138 @@ TEST_F(KrigingModelTest, updateModelWithNewData) {
 
 }
 
+TEST_F(KrigingModelTest, addNewSampleToData) {
+
+	rowvec newSample(2);
+	newSample(0) = 0.6;
+	newSample(1) = -0.2;
+
+	testModel1D.addNewSampleToData(newSample);
+
+	ASSERT_TRUE(testModel1D.getNumberOfSamples() == 11);
+
+	KrigingModel testModelCheck;
+	testModelCheck.setNameOfInputFile("testdata1D.csv");
+	testModelCheck.readData();
+	testModelCheck.setBoxConstraints(0.0, 1.0);
+	testModelCheck.normalizeData();
+	testModelCheck.initializeSurrogateModel();
+
+	rowvec xp(1);
+	xp(0) = 0.3;
+
+	double error = fabs(testModel1D.interpolate(xp) - testModelCheck.interpolate(xp));
+
+	EXPECT_LT(error, 10E-6);
+
+}
+
+TEST_F(KrigingModelTest, interpolateBatch) {
+
+	mat X(20,2,fill::randu);
+	X = X*0.5;
+
+	vec estimates;
+	vec variances;
+	testModel2D.interpolateBatch(X, estimates, &variances);
+
+	ASSERT_TRUE(estimates.size() == 20);
+	ASSERT_TRUE(variances.size() == 20);
+
+	for(unsigned int i=0; i<20; i++){
+
+		double ftilde, ssqr;
+		testModel2D.interpolateWithVariance(X.row(i), &ftilde, &ssqr);
+
+		EXPECT_LT(fabs(estimates(i) - ftilde), 10E-8*(1.0 + fabs(ftilde)));
+		EXPECT_LT(fabs(variances(i) - ssqr), 10E-8*(1.0 + fabs(ssqr)));
+	}
+
+}
+
+TEST_F(KrigingModelTest, interpolateWithVariance) {
+
+	rowvec xp(2);
+	xp(0) = 0.13;
+	xp(1) = 0.27;
+
+	double ftilde, ssqr;
+	testModel2D.interpolateWithVariance(xp, &ftilde, &ssqr);
+
+	double error = fabs(ftilde - testModel2D.interpolate(xp));
+
+	EXPECT_LT(error, 10E-8*(1.0 + fabs(ftilde)));
+	EXPECT_GE(ssqr, -10E-8);
+
+}
+
+TEST_F(KrigingModelTest, addPendingSample) {
+
+	rowvec xp(2);
+	xp(0) = 0.13;
+	xp(1) = 0.27;
+
+	double ftilde, ssqr;
+	testModel2D.interpolateWithVariance(xp, &ftilde, &ssqr);
+
+	/* Kriging believer: the variance at the pending sample vanishes */
+	testModel2D.addPendingSample(xp, testModel2D.interpolate(xp));
+	ASSERT_EQ(testModel2D.getNumberOfPendingSamples(), 1);
+
+	double ftildePending, ssqrPending;
+	testModel2D.interpolateWithVariance(xp, &ftildePending, &ssqrPending);
+
+	EXPECT_LT(ssqrPending, ssqr);
+	EXPECT_LT(fabs(ssqrPending), 10E-6*(1.0 + fabs(ssqr)));
+
+	testModel2D.removePendingSamples();
+	ASSERT_EQ(testModel2D.getNumberOfPendingSamples(), 0);
+
+	double ftildeRestored, ssqrRestored;
+	testModel2D.interpolateWithVariance(xp, &ftildeRestored, &ssqrRestored);
+
+	EXPECT_LT(fabs(ftilde - ftildeRestored), 10E-8*(1.0 + fabs(ftilde)));
+	EXPECT_LT(fabs(ssqr - ssqrRestored), 10E-8*(1.0 + fabs(ssqr)));
+
+}
+
+TEST_F(KrigingModelTest, interpolateWithGradients) {
+
+	rowvec xp(2);
+	xp(0) = 0.13;
+	xp(1) = 0.27;
+
+	double ftilde, ssqr;
+	rowvec gradientEstimate, gradientVariance;
+	testModel2D.interpolateWithGradients(xp, &ftilde, &ssqr, gradientEstimate, gradientVariance);
+
+	double ftildeCheck, ssqrCheck;
+	testModel2D.interpolateWithVariance(xp, &ftildeCheck, &ssqrCheck);
+
+	EXPECT_LT(fabs(ftilde - ftildeCheck), 10E-8*(1.0 + fabs(ftilde)));
+	EXPECT_LT(fabs(ssqr - ssqrCheck), 10E-8*(1.0 + fabs(ssqr)));
+
+	double epsilon = 10E-7;
+
+	for(unsigned int k=0; k<2; k++){
+
+		double fplus, fminus, splus, sminus;
+		rowvec xpPerturbed = xp;
+
+		xpPerturbed(k) = xp(k) + epsilon;
+		testModel2D.interpolateWithVariance(xpPerturbed, &fplus, &splus);
+		xpPerturbed(k) = xp(k) - epsilon;
+		testModel2D.interpolateWithVariance(xpPerturbed, &fminus, &sminus);
+
+		double fdEstimate = (fplus - fminus)/(2.0*epsilon);
+		double fdVariance = (splus - sminus)/(2.0*epsilon);
+
+		EXPECT_LT(fabs(gradientEstimate(k) - fdEstimate), 10E-4*(1.0 + fabs(fdEstimate)));
+		EXPECT_LT(fabs(gradientVariance(k) - fdVariance), 10E-4*(1.0 + fabs(fdVariance)));
+	}
+
+}
+
 TEST_F(KrigingModelTest, testIfConstructorWorks) {
 
 	ASSERT_TRUE(testModel2D.ifDataIsRead);
@@ -230,6 +362,56 @@ TEST_F(KrigingModelTest, calculateLikelihood) {
 }
 
 
+TEST_F(KrigingModelTest, calculateLikelihoodFunctionAndGradient) {
+
+	vec hyperParameters(4);
+	hyperParameters(0) = 2.0;
+	hyperParameters(1) = 3.0;
+	hyperParameters(2) = 1.5;
+	hyperParameters(3) = 1.8;
+
+	vec gradient;
+	double L = testModel2D.calculateLikelihoodFunctionAndGradient(hyperParameters, gradient);
+
+	ASSERT_TRUE(gradient.size() == 4);
+
+	double epsilon = 10E-7;
+
+	for(unsigned int i=0; i<4; i++){
+
+		vec hyperParametersPerturbed = hyperParameters;
+		hyperParametersPerturbed(i) += epsilon;
+
+		double Lplus = testModel2D.calculateLikelihoodFunction(hyperParametersPerturbed);
+		double finiteDifference = (Lplus - L)/epsilon;
+
+		double error = fabs(finiteDifference - gradient(i));
+		EXPECT_LT(error, 10E-3*(1.0 + fabs(gradient(i))));
+	}
+
+}
+
+TEST_F(KrigingModelTest, trainWithGradientBasedMultiStart) {
+
+	vec hyperParameters(4);
+	hyperParameters(0) = 1.0;
+	hyperParameters(1) = 1.0;
+	hyperParameters(2) = 2.0;
+	hyperParameters(3) = 2.0;
+
+	double LInitial = testModel2D.calculateLikelihoodFunction(hyperParameters);
+
+	testModel2D.setHyperParameters(hyperParameters);
+	testModel2D.setNumberOfTrainingIterations(500);
+	testModel2D.setGradientBasedTrainingOn();
+	testModel2D.train();
+
+	double LTrained = testModel2D.calculateLikelihoodFunction(testModel2D.getHyperParameters());
+
+	EXPECT_GE(LTrained, LInitial);
+
+}
+
 TEST_F(KrigingModelTest, inSampleErrorWithoutTraining) {
 
 	vec xSample(1);
@@ -303,6 +485,39 @@ TEST_F(KrigingModelTest, testKrigingOptimizertestKrigingOptimizerOptimize) {
 
 }
 
+TEST_F(KrigingModelTest, testKrigingOptimizerEvaluatesWithMoreThreads) {
+
+	unsigned int dim = 2;
+
+	KrigingHyperParameterOptimizer testOptimizer;
+	testOptimizer.initializeKrigingModelObject(testModel2D);
+	testOptimizer.setNumberOfThreads(4);
+
+	ASSERT_EQ(testOptimizer.getNumberOfThreadsForEvaluation(), 4U);
+
+	testOptimizer.setDimension(2*dim);
+	Bounds boxConstraints(2*dim);
+	vec lb(2*dim, fill::zeros);
+	vec ub(2*dim); ub(0) = 10.0; ub(1) = 10.0; ub(2) = 2.0; ub(3) = 2.0;
+	boxConstraints.setBounds(lb,ub);
+	testOptimizer.setBounds(boxConstraints);
+	testOptimizer.setNumberOfNewIndividualsInAGeneration(100);
+	testOptimizer.setNumberOfDeathsInAGeneration(50);
+	testOptimizer.setInitialPopulationSize(100);
+	testOptimizer.setMutationProbability(0.1);
+	testOptimizer.setMaximumNumberOfGeneratedIndividuals(100000);
+	testOptimizer.setNumberOfGenerations(2);
+
+	testOptimizer.optimize();
+
+	/* each thread works on its own copy, the values must be the same as in a serial evaluation */
+	EAIndividual solution = testOptimizer.getSolution();
+	double L = testModel2D.calculateLikelihoodFunction(solution.getGenes());
+
+	EXPECT_NEAR(solution.getObjectiveFunctionValue(), -L, 10E-8);
+
+}
+
 
 
 
@@ -115,6 +115,62 @@ TEST_F(CholeskySystemTest, testsolveLinearSystem){
 
 }
 
+TEST_F(CholeskySystemTest, testsolveLinearSystemMultipleRhs){
+
+	mat X = randu<mat>(test.getDimension(),3);
+
+	mat A = test.getMatrix();
+	mat B = A*X;
+
+	test.factorize();
+
+	mat Xsol = test.solveLinearSystem(B);
+
+	mat error = X-Xsol;
+
+	ASSERT_TRUE(error.is_zero(10E-6));
+
+}
+
+TEST_F(CholeskySystemTest, testcalculateInverse){
+
+	mat A = test.getMatrix();
+
+	test.factorize();
+
+	mat Ainv = test.calculateInverse();
+
+	mat error = A*Ainv - eye<mat>(A.n_rows,A.n_cols);
+
+	ASSERT_TRUE(error.is_zero(10E-6));
+
+}
+
+TEST_F(CholeskySystemTest, testaddRowAndColumn){
+
+	mat A = test.getMatrix();
+	vec newColumn = randu<vec>(test.getDimension()+1);
+
+	mat Aextended(A.n_rows+1, A.n_cols+1);
+	Aextended.submat(0,0,A.n_rows-1,A.n_cols-1) = A;
+	Aextended.col(A.n_cols) = newColumn;
+	Aextended.row(A.n_rows) = trans(newColumn);
+	Aextended(A.n_rows,A.n_cols) = newColumn(A.n_rows) + 100.0;
+	newColumn(A.n_rows) = Aextended(A.n_rows,A.n_cols);
+
+	test.factorize();
+	test.addRowAndColumn(newColumn);
+
+	ASSERT_TRUE(test.isFactorizationDone());
+	ASSERT_TRUE(test.checkDimension(11));
+
+	mat L = test.getLowerDiagonalMatrix();
+	mat error = Aextended - L*trans(L);
+
+	ASSERT_TRUE(error.is_zero(10E-6));
+
+}
+
 TEST_F(CholeskySystemTest, testcalculateDeterminant){
 
 
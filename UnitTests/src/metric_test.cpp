@@ -218,6 +218,15 @@ TEST_F(MetricTest, testinitializeWeightedL1NormObject){
 
 }
 
+TEST_F(MetricTest, testWeightedL1NormOptimizerIsReentrant){
+
+	WeightedL1NormOptimizer testOptimizer;
+	testOptimizer.setNumberOfThreads(4);
+
+	ASSERT_EQ(testOptimizer.getNumberOfThreadsForEvaluation(), 4U);
+
+}
+
 
 
 TEST_F(MetricTest, testfindOptimalWeights){
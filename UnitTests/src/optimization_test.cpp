@@ -37,11 +37,25 @@
 #include "design.hpp"
 #include "test_defines.hpp"
 #include<gtest/gtest.h>
+#include<fstream>
+#include<cstdlib>
 
 
 
 #ifdef OPTIMIZATION_TEST
 
+/* number of lines in a text file, zero if the file does not exist */
+static unsigned int countLinesInFile(std::string filename){
+
+	std::ifstream inputFileStream(filename);
+	std::string line;
+	unsigned int count = 0;
+
+	while(std::getline(inputFileStream, line)) count++;
+
+	return count;
+}
+
 
 class OptimizationTest : public ::testing::Test {
 protected:
@@ -159,6 +173,37 @@ protected:
 
 	}
 
+	/* two constraints evaluated by constraintGroup.cpp, the executable names and the output files define the groups */
+	void prepareConstraintGroups(std::string executable1, std::string output1, std::string executable2, std::string output2){
+
+		compileWithCpp("constraintGroup.cpp", "constraintGroupA");
+		compileWithCpp("constraintGroup.cpp", "constraintGroupB");
+
+		remove("constraintGroupRuns.dat");
+		remove("constraintGroupOverlap.dat");
+		removeDirectory("constraintGroupRunning");
+		unsetenv("CONSTRAINT_GROUP_RUNS");
+
+		constraintDefinition1.executableName = executable1;
+		constraintDefinition1.outputFilename = output1;
+		constraintDefinition1.setDefinition("constraintGroupFirst > 0.0");
+		constraintDefinition1.nameHighFidelityTrainingData = "constraintGroupFirst.csv";
+
+		constraintDefinition2.executableName = executable2;
+		constraintDefinition2.outputFilename = output2;
+		constraintDefinition2.setDefinition("constraintGroupSecond > 0.0");
+		constraintDefinition2.nameHighFidelityTrainingData = "constraintGroupSecond.csv";
+
+		constraintFunc1.setParametersByDefinition(constraintDefinition1);
+		constraintFunc1.setID(0);
+		testOptimizer.addConstraint(constraintFunc1);
+
+		constraintFunc2.setParametersByDefinition(constraintDefinition2);
+		constraintFunc2.setID(1);
+		testOptimizer.addConstraint(constraintFunc2);
+
+	}
+
 	void TearDown() override {
 
 
@@ -388,10 +433,201 @@ TEST_F(OptimizationTest, EGOUnconstrained){
 
 }
 
+TEST_F(OptimizationTest, EGOUnconstrainedAsynchronous){
+
+	compileWithCpp("himmelblau.cpp", definition.executableName);
+	himmelblauFunction.function.generateTrainingSamples();
+
+	objFunHimmelblau.setParametersByDefinition(definition);
+
+	testOptimizer.setMaximumNumberOfIterations(10);
+	testOptimizer.setNumberOfJobSlots(2);
+	testOptimizer.addObjectFunction(objFunHimmelblau);
+	testOptimizer.EfficientGlobalOptimization();
+
+	mat results;
+	results.load("himmelblau.csv", csv_ascii);
+
+	ASSERT_TRUE(results.n_rows == 60);
+
+	/* the job slots must not read the outputs of each other, the design vector file has six significant digits */
+	for(unsigned int i=50; i<60; i++){
+
+		rowvec x = results.row(i).head(2);
+		EXPECT_NEAR(results(i,2), Himmelblau(x.memptr()), 10E-2);
+	}
+
+	ASSERT_FALSE(directory_exist("HimmelblauOptimization_JobSlots"));
+
+}
+
+TEST_F(OptimizationTest, evaluateConstraintsRunsASharedExecutableOnce){
 
+	prepareConstraintGroups("constraintGroupA", "constraintGroup1.dat", "constraintGroupA", "constraintGroup2.dat");
+
+	rowvec dv(2); dv(0) = 1.0; dv(1) = 2.0;
+	Design d(dv);
+	d.setNumberOfConstraints(2);
+
+	testOptimizer.evaluateConstraints(d);
+
+	ASSERT_EQ(countLinesInFile("constraintGroupRuns.dat"), 1U);
+	EXPECT_NEAR(d.constraintTrueValues(0),  3.0, 10E-8);
+	EXPECT_NEAR(d.constraintTrueValues(1), -1.0, 10E-8);
+
+}
+
+TEST_F(OptimizationTest, evaluateConstraintsDoesNotRunGroupsWithTheSameOutputFileConcurrently){
+
+	prepareConstraintGroups("constraintGroupA", "constraintGroup1.dat", "constraintGroupB", "constraintGroup1.dat");
+
+	rowvec dv(2); dv(0) = 1.0; dv(1) = 2.0;
+	Design d(dv);
+	d.setNumberOfConstraints(2);
+
+	testOptimizer.evaluateConstraints(d);
+
+	ASSERT_EQ(countLinesInFile("constraintGroupRuns.dat"), 2U);
+	ASSERT_FALSE(file_exist("constraintGroupOverlap.dat"));
+
+	/* each constraint has read the output of its own executable */
+	EXPECT_NEAR(d.constraintTrueValues(0),   3.0, 10E-8);
+	EXPECT_NEAR(d.constraintTrueValues(1), 103.0, 10E-8);
+
+}
 
+TEST_F(OptimizationTest, evaluateConstraintsRunsIndependentGroupsConcurrently){
+
+	prepareConstraintGroups("constraintGroupA", "constraintGroup1.dat", "constraintGroupB", "constraintGroup2.dat");
+
+	rowvec dv(2); dv(0) = 1.0; dv(1) = 2.0;
+	Design d(dv);
+	d.setNumberOfConstraints(2);
+
+	testOptimizer.evaluateConstraints(d);
+
+	/* both executables write both files in the same directory, therefore only the overlap is checked */
+	ASSERT_EQ(countLinesInFile("constraintGroupRuns.dat"), 2U);
+	ASSERT_TRUE(file_exist("constraintGroupOverlap.dat"));
+
+}
+
+TEST_F(OptimizationTest, DoEContinuesWithTheSamplesWithoutResults){
+
+	compileWithCpp("constraintGroup.cpp", "constraintGroupA");
+
+	std::string filenameRuns = getAbsolutePath("constraintGroupRuns.dat");
+	remove(filenameRuns.c_str());
+	setenv("CONSTRAINT_GROUP_RUNS", filenameRuns.c_str(), 1);
+
+	definition.executableName = "constraintGroupA";
+	definition.outputFilename = "constraintGroup1.dat";
+	definition.name = "constraintGroupObjective";
+	definition.nameHighFidelityTrainingData = "constraintGroupObjective.csv";
+
+	objFunHimmelblau.setParametersByDefinition(definition);
+	testOptimizer.addObjectFunction(objFunHimmelblau);
+
+	remove("constraintGroupObjective.csv");
+
+	/* an interrupted DoE: the samples 0 and 2 have their results, the samples 1 and 3 not */
+
+	unsigned int howManySamples = 4;
+	mat samples(howManySamples, 2);
+	samples(0,0) = -1.0; samples(0,1) =  2.0;
+	samples(1,0) =  3.0; samples(1,1) = -4.0;
+	samples(2,0) =  5.0; samples(2,1) =  1.0;
+	samples(3,0) = -2.0; samples(3,1) = -3.0;
+
+	removeDirectory("HimmelblauOptimization_DoE");
+	ASSERT_TRUE(createDirectory("HimmelblauOptimization_DoE"));
+	samples.save("HimmelblauOptimization_DoE/samples.csv", csv_ascii);
+
+	for(unsigned int sampleID=0; sampleID<howManySamples; sampleID+=2){
+
+		std::string directorySample = "HimmelblauOptimization_DoE/sample" + std::to_string(sampleID);
+		ASSERT_TRUE(createDirectory(directorySample));
+
+		rowvec result(1);
+		result(0) = 1000.0 + sampleID;
+		result.save(directorySample + "/result.csv", csv_ascii);
+	}
+
+	testOptimizer.performDoE(howManySamples, LHS);
+
+	unsetenv("CONSTRAINT_GROUP_RUNS");
+
+	/* only the samples without results are evaluated */
+	ASSERT_EQ(countLinesInFile(filenameRuns), 2U);
+
+	mat objectiveFunctionData;
+	objectiveFunctionData.load("constraintGroupObjective.csv", csv_ascii);
+
+	ASSERT_EQ(objectiveFunctionData.n_rows, howManySamples);
+
+	/* the training data is in the order of the samples */
+	for(unsigned int i=0; i<howManySamples; i++){
+
+		EXPECT_EQ(objectiveFunctionData(i,0), samples(i,0));
+		EXPECT_EQ(objectiveFunctionData(i,1), samples(i,1));
+	}
+
+	EXPECT_NEAR(objectiveFunctionData(0,2), 1000.0, 10E-8);
+	EXPECT_NEAR(objectiveFunctionData(1,2), -1.0, 10E-8);
+	EXPECT_NEAR(objectiveFunctionData(2,2), 1002.0, 10E-8);
+	EXPECT_NEAR(objectiveFunctionData(3,2), -5.0, 10E-8);
+
+	ASSERT_FALSE(directory_exist("HimmelblauOptimization_DoE"));
+
+}
+
+TEST_F(OptimizationTest, DoEReusesTheObjectiveFunctionOutputForAConstraint){
+
+	prepareConstraintGroups("constraintGroupA", "constraintGroup2.dat", "constraintGroupB", "constraintGroup2.dat");
+
+	/* the DoE samples run in their own directories, the runs are counted in the current directory */
+	std::string filenameRuns = getAbsolutePath("constraintGroupRuns.dat");
+	setenv("CONSTRAINT_GROUP_RUNS", filenameRuns.c_str(), 1);
+
+	definition.executableName = "constraintGroupA";
+	definition.outputFilename = "constraintGroup1.dat";
+	definition.name = "constraintGroupObjective";
+	definition.nameHighFidelityTrainingData = "constraintGroupObjective.csv";
+
+	objFunHimmelblau.setParametersByDefinition(definition);
+	testOptimizer.addObjectFunction(objFunHimmelblau);
+
+	remove("constraintGroupObjective.csv");
+	remove("constraintGroupFirst.csv");
+	remove("constraintGroupSecond.csv");
+	removeDirectory("HimmelblauOptimization_DoE");
+
+	unsigned int howManySamples = 3;
+	testOptimizer.performDoE(howManySamples, LHS);
+
+	unsetenv("CONSTRAINT_GROUP_RUNS");
+
+	/* constraintGroupA runs once for the objective function and the first constraint, constraintGroupB once */
+	ASSERT_EQ(countLinesInFile(filenameRuns), 2*howManySamples);
+
+	mat objectiveFunctionData;
+	objectiveFunctionData.load("constraintGroupObjective.csv", csv_ascii);
+	mat constraintData;
+	constraintData.load("constraintGroupFirst.csv", csv_ascii);
+
+	ASSERT_EQ(objectiveFunctionData.n_rows, howManySamples);
+	ASSERT_EQ(constraintData.n_rows, howManySamples);
+
+	for(unsigned int i=0; i<howManySamples; i++){
+
+		double x1 = objectiveFunctionData(i,0);
+		double x2 = objectiveFunctionData(i,1);
+		EXPECT_NEAR(objectiveFunctionData(i,2), x1 + x2, 10E-4);
+		EXPECT_NEAR(constraintData(i,2), x1 - x2, 10E-4);
+	}
+
+}
 
-TEST_F(OptimizationTest, trainSurrogates){
 
 	prepareObjectiveFunction();
 	prepareFirstConstraint();
@@ -0,0 +1,101 @@
+/*
+ * RoDeO, a Robust Design Optimization Package
+ *
+ * Copyright (C) 2015-2023 Chair for Scientific Computing (SciComp), RPTU
+ * Homepage: http://www.scicomp.uni-kl.de
+ * Contact:  Prof. Nicolas R. Gauger (nicolas.gauger@scicomp.uni-kl.de) or Dr. Emre Özkaya (emre.oezkaya@scicomp.uni-kl.de)
+ *
+ * Lead developer: Emre Özkaya (SciComp, RPTU)
+ *
+ * This file is part of RoDeO
+ *
+ * RoDeO is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * RoDeO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details.
+ * You should have received a copy of the GNU
+ * General Public License along with RoDeO.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors: Emre Özkaya, (SciComp, RPTU)
+ *
+ *
+ *
+ */
+
+#include "simulation_worker.hpp"
+#include "test_defines.hpp"
+#include<gtest/gtest.h>
+#include<fstream>
+#include<cstdio>
+#include<sys/stat.h>
+
+#ifdef TEST_SIMULATION_WORKER
+
+/* cat echoes the request back, so the reply must be identical to the input */
+
+TEST(testSimulationWorker, evaluateWithEchoWorker){
+
+	SimulationWorker worker;
+
+	ASSERT_TRUE(worker.start("/bin/cat"));
+	ASSERT_TRUE(worker.isRunning());
+
+	std::vector<double> input = {1.0, -2.5, 3.25};
+	std::vector<double> output;
+
+	ASSERT_TRUE(worker.evaluate(input, output));
+	ASSERT_EQ(output.size(), input.size());
+
+	for(unsigned int i=0; i<input.size(); i++){
+		EXPECT_EQ(output[i], input[i]);
+	}
+
+	worker.stop();
+	ASSERT_FALSE(worker.isRunning());
+
+}
+
+TEST(testSimulationWorker, startFailsForMissingExecutable){
+
+	SimulationWorker worker;
+
+	std::vector<double> input = {1.0};
+	std::vector<double> output;
+
+	ASSERT_FALSE(worker.start("./thisExecutableDoesNotExist"));
+	ASSERT_FALSE(worker.isRunning());
+	ASSERT_FALSE(worker.evaluate(input, output));
+
+}
+
+/* the worker ignores the termination request and the closed pipes, stop() must kill it after the timeout */
+
+TEST(testSimulationWorker, stopKillsWorkerThatDoesNotTerminate){
+
+	std::string script = "./testWorkerThatDoesNotTerminate.sh";
+
+	std::ofstream scriptFile(script);
+	scriptFile << "#!/bin/sh\nexec sleep 60\n";
+	scriptFile.close();
+	chmod(script.c_str(), 0755);
+
+	SimulationWorker worker;
+	worker.setTimeoutForTermination(100);
+
+	ASSERT_TRUE(worker.start(script));
+
+	worker.stop();
+	ASSERT_FALSE(worker.isRunning());
+
+	remove(script.c_str());
+
+}
+
+#endif
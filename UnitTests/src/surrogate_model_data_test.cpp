@@ -253,6 +253,143 @@ TEST_F(SurrogateModelDataTest, testnormalizeSampleInputMatrix) {
 
 }
 
+TEST_F(SurrogateModelDataTest, testgetPointerToRowXAfterNormalization) {
+
+	testSurrogateModelData.setGradientsOn();
+	generateAndReadRandomTrainingDataWithGradients();
+
+	vec lb(5, fill::zeros);
+	vec ub(5, fill::ones);
+	Bounds boxConstraints(lb,ub);
+	testSurrogateModelData.setBoxConstraints(boxConstraints);
+
+	testSurrogateModelData.normalizeSampleInputMatrix();
+
+	unsigned int someRowIndex = 11;
+	const double *x = testSurrogateModelData.getPointerToRowX(someRowIndex);
+	rowvec xRow = testSurrogateModelData.getRowX(someRowIndex);
+
+	for(unsigned int i=0; i<testSurrogateModelData.getDimension(); i++){
+
+		EXPECT_EQ(x[i], xRow(i));
+		EXPECT_EQ(testSurrogateModelData.getRowXView(someRowIndex)(i), xRow(i));
+	}
+
+}
+
+TEST_F(SurrogateModelDataTest, testappendSample) {
+
+	unsigned int N = 20;
+	unsigned int dim = 3;
+
+	mat testDataMatrix(N+1, dim+1, fill::randu);
+	saveMatToCVSFile(testDataMatrix.rows(0,N-1), "trainingDataAppendSample.csv");
+
+	Bounds boxConstraints(dim);
+	boxConstraints.setBounds(0.0, 1.0);
+
+	testSurrogateModelData.readData("trainingDataAppendSample.csv");
+	testSurrogateModelData.setBoxConstraints(boxConstraints);
+	testSurrogateModelData.normalize();
+
+	rowvec newSample = testDataMatrix.row(N);
+	testSurrogateModelData.appendSample(newSample);
+	SurrogateModelData::appendSampleToFileAsynchronously(newSample, "trainingDataAppendSample.csv");
+
+	SurrogateModelData dataReadFromFile;
+	dataReadFromFile.readData("trainingDataAppendSample.csv");
+	dataReadFromFile.setBoxConstraints(boxConstraints);
+	dataReadFromFile.normalize();
+
+	ASSERT_EQ(testSurrogateModelData.getNumberOfSamples(), N+1);
+	ASSERT_EQ(dataReadFromFile.getNumberOfSamples(), N+1);
+	ASSERT_TRUE(isEqual(mat(testSurrogateModelData.getInputMatrix()), mat(dataReadFromFile.getInputMatrix()), 10E-10));
+	ASSERT_TRUE(isEqual(vec(testSurrogateModelData.getOutputVector()), vec(dataReadFromFile.getOutputVector()), 10E-10));
+
+	const double *x = testSurrogateModelData.getPointerToRowX(N);
+	for(unsigned int i=0; i<dim; i++){
+		EXPECT_EQ(x[i], testSurrogateModelData.getRowX(N)(i));
+	}
+
+	remove("trainingDataAppendSample.csv");
+}
+
+TEST_F(SurrogateModelDataTest, testcopyOnWrite) {
+
+	unsigned int N = 20;
+	unsigned int dim = 3;
+
+	mat testDataMatrix(N+1, dim+1, fill::randu);
+	saveMatToCVSFile(testDataMatrix.rows(0,N-1), "trainingDataCopyOnWrite.csv");
+
+	testSurrogateModelData.readData("trainingDataCopyOnWrite.csv");
+
+	SurrogateModelData sharedData = testSurrogateModelData;
+	ASSERT_TRUE(sharedData.isDataSharedWith(testSurrogateModelData));
+
+	Bounds boxConstraints(dim);
+	boxConstraints.setBounds(0.0, 1.0);
+	sharedData.setBoxConstraints(boxConstraints);
+	sharedData.normalize();
+
+	ASSERT_FALSE(sharedData.isDataSharedWith(testSurrogateModelData));
+	ASSERT_TRUE(isEqual(testSurrogateModelData.getRowX(0), rowvec(testDataMatrix.row(0).head(dim)), 10E-10));
+
+	remove("trainingDataCopyOnWrite.csv");
+}
+
+TEST_F(SurrogateModelDataTest, testappendSampleToSharedData) {
+
+	unsigned int N = 20;
+	unsigned int dim = 3;
+
+	mat testDataMatrix(N+2, dim+1, fill::randu);
+	saveMatToCVSFile(testDataMatrix.rows(0,N-1), "trainingDataAppendSampleToSharedData.csv");
+
+	testSurrogateModelData.readData("trainingDataAppendSampleToSharedData.csv");
+
+	SurrogateModelData sharedData = testSurrogateModelData;
+
+	/* the sample is written to a spare row of the shared matrices, the other copy does not see it */
+
+	testSurrogateModelData.appendSample(testDataMatrix.row(N));
+
+	ASSERT_TRUE(sharedData.isDataSharedWith(testSurrogateModelData));
+	ASSERT_EQ(testSurrogateModelData.getNumberOfSamples(), N+1);
+	ASSERT_EQ(testSurrogateModelData.getInputMatrix().n_rows, N+1);
+	ASSERT_EQ(sharedData.getNumberOfSamples(), N);
+	ASSERT_EQ(sharedData.getInputMatrix().n_rows, N);
+	ASSERT_EQ(sharedData.getOutputVector().n_rows, N);
+
+	/* a sub-model taking over the data sees the new sample without a copy */
+
+	SurrogateModelData dataOfTheSubModel = testSurrogateModelData;
+	ASSERT_TRUE(dataOfTheSubModel.isDataSharedWith(sharedData));
+	ASSERT_TRUE(isEqual(dataOfTheSubModel.getRowRawData(N), rowvec(testDataMatrix.row(N)), 10E-10));
+
+	/* the row after the N samples of the other copy is already taken, therefore the matrices are copied */
+
+	sharedData.appendSample(testDataMatrix.row(N+1));
+
+	ASSERT_FALSE(sharedData.isDataSharedWith(testSurrogateModelData));
+	ASSERT_TRUE(isEqual(sharedData.getRowRawData(N), rowvec(testDataMatrix.row(N+1)), 10E-10));
+	ASSERT_TRUE(isEqual(testSurrogateModelData.getRowRawData(N), rowvec(testDataMatrix.row(N)), 10E-10));
+
+	/* more samples than the initial spare rows */
+
+	for(unsigned int i=0; i<3*N; i++){
+
+		testSurrogateModelData.appendSample(testDataMatrix.row(i%N));
+	}
+
+	ASSERT_EQ(testSurrogateModelData.getNumberOfSamples(), 4*N+1);
+	ASSERT_EQ(testSurrogateModelData.getRawData().n_rows, 4*N+1);
+	ASSERT_TRUE(isEqual(testSurrogateModelData.getRowRawData(4*N), rowvec(testDataMatrix.row(N-1)), 10E-10));
+	EXPECT_EQ(testSurrogateModelData.getOutputVector()(4*N), testDataMatrix(N-1,dim));
+
+	remove("trainingDataAppendSampleToSharedData.csv");
+}
+
 TEST_F(SurrogateModelDataTest, testassignGradientMatrix) {
 
 	unsigned int dim = 6;
@@ -289,15 +289,17 @@ TEST_F(TGEKModelTest, prepareTrainingDataForTheKrigingModel) {
 	testModel.setNameOfInputFile("trainingSamplesHimmelblauTGEK.csv");
 	//	testModel.setDisplayOn();
 	testModel.readData();
+	testModel.setBoxConstraints(-6.0, 6.0);
+	testModel.normalizeData();
 	testModel.prepareTrainingDataForTheKrigingModel();
 
-	mat trainingDataForKriging;
-	trainingDataForKriging.load("auxiliaryData.csv", csv_ascii);
-
-	mat traingDataCheck = trainingData.submat(0, 0, 49, 2);
+	const KrigingModel &auxiliaryModel = testModel.getAuxiliaryModel();
 
-	bool ifValuesAreOk = checkMatrix(traingDataCheck, trainingDataForKriging);
-	ASSERT_TRUE(ifValuesAreOk);
+	ASSERT_TRUE(auxiliaryModel.ifNormalized);
+	ASSERT_TRUE(isEqual(mat(auxiliaryModel.getX()), mat(testModel.getX()), 10E-10));
+	vec yCheck = trainingData.col(2);
+	ASSERT_TRUE(isEqual(vec(auxiliaryModel.gety()), yCheck, 10E-10));
+	ASSERT_FALSE(file_exist("auxiliaryData.csv"));
 
 }
 
@@ -389,6 +391,54 @@ TEST_F(TGEKModelTest, addNewSampleToData) {
 
 }
 
+TEST_F(TGEKModelTest, addNewSampleToDataAfterTraining) {
+
+	generate2DHimmelblauDataForTGEKModel(11);
+	saveMatToCVSFile(trainingData.rows(0,9), "trainingSamplesHimmelblauTGEK.csv");
+
+	testModel.setNameOfInputFile("trainingSamplesHimmelblauTGEK.csv");
+	testModel.readData();
+	testModel.setBoxConstraints(-6.0, 6.0);
+	testModel.setNumberOfTrainingIterations(1000);
+	testModel.normalizeData();
+	testModel.initializeSurrogateModel();
+	testModel.train();
+
+	vec theta = testModel.getHyperParameters();
+	SurrogateModelData dataBeforeTheNewSample = testModel.getData();
+
+	/* Phi is extended with the new sample, the hyperparameters do not change */
+	testModel.addNewSampleToData(trainingData.row(10));
+
+	ASSERT_EQ(testModel.getNumberOfSamples(), 11);
+	ASSERT_TRUE(isEqual(testModel.getHyperParameters(), theta, 10E-10));
+
+	/* the sample is appended to the shared sample matrices without a copy, the Kriging model sees it */
+	ASSERT_TRUE(testModel.getData().isDataSharedWith(dataBeforeTheNewSample));
+	ASSERT_TRUE(testModel.getAuxiliaryModel().getData().isDataSharedWith(testModel.getData()));
+	ASSERT_EQ(testModel.getAuxiliaryModel().getNumberOfSamples(), 11);
+
+	/* same model, Phi calculated from scratch */
+	saveMatToCVSFile(trainingData, "trainingSamplesHimmelblauTGEKAll.csv");
+
+	TGEKModel testModelAllSamples;
+	testModelAllSamples.setNameOfInputFile("trainingSamplesHimmelblauTGEKAll.csv");
+	testModelAllSamples.readData();
+	testModelAllSamples.setBoxConstraints(-6.0, 6.0);
+	testModelAllSamples.normalizeData();
+	testModelAllSamples.initializeSurrogateModel();
+	testModelAllSamples.setHyperParameters(theta);
+	testModelAllSamples.updateAuxilliaryFields();
+
+	rowvec x(2, fill::randu);
+	x = x*0.5;
+
+	EXPECT_NEAR(testModel.interpolate(x), testModelAllSamples.interpolate(x), 10E-6);
+
+	remove("trainingSamplesHimmelblauTGEKAll.csv");
+
+}
+
 
 
 //TEST_F(TGEKModelTest, calculateOutSampleError1DFunction) {
@@ -60,6 +60,7 @@ public:
 	void setNameOfInputFile(std::string);
 	void setNameOfHyperParametersFile(std::string);
 	void setNumberOfTrainingIterations(unsigned int);
+	void setGradientBasedTrainingOn(void);
 
 	void initializeSurrogateModel(void);
 	void printSurrogateModel(void) const;
@@ -80,8 +81,8 @@ public:
 	double calculateDualModelWeight(const rowvec &, int) const;
 
 	double interpolate(rowvec) const ;
-	double interpolateWithGradients(rowvec) const ;
 	void interpolateWithVariance(rowvec,double *,double *) const;
+	void interpolateBatch(const mat &X, vec &estimates, vec *variances = NULL) const;
 
 //	void calculateExpectedImprovement(CDesignExpectedImprovement &) const;
 
@@ -141,6 +141,12 @@ double calculateProbalityGreaterThanAValue(double value, double mu, double sigma
 bool file_exist(const char *fileName);
 bool file_exist(std::string filename);
 
+bool directory_exist(std::string directory);
+bool createDirectory(std::string directory);
+void removeDirectory(std::string directory);
+std::string getAbsolutePath(std::string path);
+std::string quoteForShell(std::string text);
+
 void readFileToaString(std::string, std::string &);
 
 
@@ -0,0 +1,111 @@
+/*
+ * RoDeO, a Robust Design Optimization Package
+ *
+ * Copyright (C) 2015-2021 Chair for Scientific Computing (SciComp), TU Kaiserslautern
+ * Homepage: http://www.scicomp.uni-kl.de
+ * Contact:  Prof. Nicolas R. Gauger (nicolas.gauger@scicomp.uni-kl.de) or Dr. Emre Özkaya (emre.oezkaya@scicomp.uni-kl.de)
+ *
+ * Lead developer: Emre Özkaya (SciComp, TU Kaiserslautern)
+ *
+ * This file is part of RoDeO
+ *
+ * RoDeO is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * RoDeO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details.
+ * You should have received a copy of the GNU
+ * General Public License along with CoDiPack.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors: Emre Özkaya, (SciComp, TU Kaiserslautern)
+ *
+ *
+ *
+ */
+
+#ifndef BINARY_DATA_FILE_HPP
+#define BINARY_DATA_FILE_HPP
+
+#include <string>
+#include <cstdio>
+#include <armadillo>
+#include "bounds.hpp"
+
+using namespace arma;
+
+
+/** Binary training data file, an alternative to the csv files for large data sets.
+ *
+ * The columns of the data (design variables, function value, gradient or tangent) are stored one after the other,
+ * each with room for "capacity" rows, so that a new sample is appended in place by writing one value at the end of
+ * every column. The file is mapped read-only when it is read, no parsing is necessary. File format (native byte order):
+ *
+ *   header (64 bytes): "RODEOBD1", uint32 dimension, uint32 flags, uint32 number of columns, uint32 (unused),
+ *                      uint64 number of rows, uint64 capacity, 24 bytes (unused)
+ *   box constraints:   lower bounds, upper bounds (2*dimension doubles, valid if the bounds flag is set)
+ *   data:              number of columns x capacity doubles, column by column
+ *
+ * The number of rows is updated after the values of a new row are written, therefore an interrupted append does not
+ * leave an incomplete sample behind.
+ */
+
+class BinaryDataFile{
+
+private:
+
+	std::string filename;
+
+	unsigned int dimension = 0;
+	unsigned int numberOfColumns = 0;
+	unsigned long long numberOfRows = 0;
+	unsigned long long capacity = 0;
+
+	bool ifDataHasGradients = false;
+	bool ifDataHasDirectionalDerivatives = false;
+
+	Bounds boxConstraints;
+
+	bool assignHeader(const char *buffer, size_t size);
+	void writeHeader(FILE *) const;
+	size_t getDataOffset(void) const;
+	unsigned int calculateDimension(unsigned int numberOfColumnsData) const;
+
+public:
+
+	static const unsigned long long minimumCapacity = 1024;
+
+	BinaryDataFile(std::string filename);
+
+	static bool checkIfBinaryDataFile(std::string filename);
+
+	void setGradientsOn(void);
+	void setDirectionalDerivativesOn(void);
+	void setBoxConstraints(Bounds);
+
+	bool readHeader(void);
+	mat read(void);
+	void write(const mat &data, unsigned long long capacityToReserve = 0);
+	void appendRow(const rowvec &);
+	void appendRows(const mat &);
+
+	void importFromCSV(std::string filenameCSV);
+	void exportToCSV(std::string filenameCSV);
+
+	unsigned int getDimension(void) const;
+	unsigned int getNumberOfColumns(void) const;
+	unsigned long long getNumberOfRows(void) const;
+	unsigned long long getCapacity(void) const;
+	bool checkIfDataHasGradients(void) const;
+	bool checkIfDataHasDirectionalDerivatives(void) const;
+	Bounds getBoxConstraints(void) const;
+
+};
+
+
+#endif
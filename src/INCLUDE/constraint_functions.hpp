@@ -84,9 +84,8 @@ public:
 	void setID(int givenID);
 	int getID(void) const;
 
-	void readOutputDesign(Design &d) const;
+	void assignOutputsToDesign(Design &d, const rowvec &outputs) const;
 
-	void evaluateDesign(Design &d);
 	void addDesignToData(Design &d);
 
 	void print(void) const;
@@ -32,6 +32,8 @@
 #define CORRELATION_FUNCTIONS_HPP
 
 #include <armadillo>
+#include <vector>
+#include <memory>
 #include "correlation_functions.hpp"
 using namespace arma;
 
@@ -78,8 +80,10 @@ protected:
 
 
 	mat X;
+	mat XSampleMajor;      // transpose of X, each sample is a contiguous column
 	unsigned int N = 0;
 	unsigned int dim = 0;
+	unsigned int tileSize = 64;
 	mat correlationMatrix;
 	mat correlationMatrixDot;
 	vec correlationVec;
@@ -94,6 +98,7 @@ public:
 	CorrelationFunctionBase();
 
 	void setInputSampleMatrix(mat);
+	vec addNewSampleToInputMatrix(const rowvec &);
 	void setEpsilon(double);
 	void setDimension(unsigned int);
 	virtual void setHyperParameters(vec) = 0;
@@ -114,10 +119,14 @@ public:
 	virtual double compute_dR_dxi(const rowvec &, const rowvec &, unsigned int) const;
 	virtual double compute_dR_dxj(const rowvec &, const rowvec &, unsigned int) const;
 	virtual double compute_d2R_dxl_dxk(const rowvec &, const rowvec &, unsigned int ,unsigned int) const;
+	virtual void computeCorrelationBlockOfSamplePair(unsigned int i, unsigned int j, mat &block) const;
 
 	vec computeCorrelationVector(const rowvec &x) const;
+	mat computeCorrelationMatrixForPoints(const mat &Xpoints) const;
 
 	virtual double computeCorrelation(const rowvec &x_i, const rowvec &x_j) const = 0;
+	virtual double computeCorrelation(const double *x_i, const double *x_j) const;
+	virtual double computeCorrelationOfSamplePair(unsigned int i, unsigned int j) const;
 	virtual bool checkIfParametersAreSetProperly(void) const = 0;
 
 
@@ -131,6 +140,11 @@ private:
 	vec theta;
 	vec gamma;
 
+	/* log|x_i(k) - x_j(k)| for all pairs i<j, pair (i,j) is stored at (j*(j-1)/2 + i)*dim.
+	 * The cache is shared by the copies of the correlation function (e.g. the model copies used in the training) */
+	std::shared_ptr<const std::vector<double> > logDistanceCache;
+	double maximumMemoryForDistanceCache = 512.0; /* in MB */
+	bool ifDistanceCacheIsBuilt = false;
 
 
 public:
@@ -139,6 +153,11 @@ public:
 	void setTheta(vec);
 	void setGamma(vec);
 
+	void setMaximumMemoryForDistanceCache(double);
+	void buildDistanceCache(void);
+	void clearDistanceCache(void);
+	bool isDistanceCacheBuilt(void) const;
+
 	void print(void) const;
 
 
@@ -146,8 +165,15 @@ public:
 	void setHyperParameters(vec);
 	vec getHyperParameters(void) const;
 	double computeCorrelation(const rowvec &, const rowvec &) const;
+	double computeCorrelation(const double *, const double *) const;
+	double computeCorrelationOfSamplePair(unsigned int i, unsigned int j) const;
 	bool checkIfParametersAreSetProperly(void) const;
 
+	vec computeWeightedHyperParameterDerivatives(const mat &weights) const;
+	mat computeCorrelationVectorGradient(const rowvec &xp, const vec &r) const;
+
+	void setInputSampleMatrix(mat);
+	vec addNewSampleToInputMatrix(const rowvec &);
 
 
 };
@@ -190,11 +216,14 @@ public:
 	double computeCorrelation(const rowvec &, const rowvec &) const;
 	bool checkIfParametersAreSetProperly(void) const;
 
+	double computeCorrelation(const double *, const double *) const;
 	double computeCorrelationDot(const rowvec &x_i, const rowvec &x_j, const rowvec &diffDirection) const;
+	double computeCorrelationDot(const double *x_i, const double *x_j, const double *diffDirection) const;
 	double computeCorrelationDotDot(const rowvec &x_i, const rowvec &x_j, const rowvec &firstDiffDirection, const rowvec &secondDiffDirection) const;
 	double compute_dR_dxi(const rowvec &xi, const rowvec &xj, unsigned int k) const;
 	double compute_dR_dxj(const rowvec &xi, const rowvec &xj, unsigned int k) const;
 	double compute_d2R_dxl_dxk(const rowvec &, const rowvec &, unsigned int ,unsigned int) const;
+	void computeCorrelationBlockOfSamplePair(unsigned int i, unsigned int j, mat &block) const;
 
 	double computeCorrelation(unsigned int i, unsigned int j) const;
 	double computeCorrelationDot(unsigned int i, unsigned int j, const rowvec &diffDirection) const;
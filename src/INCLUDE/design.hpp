@@ -42,6 +42,7 @@ public:
 	rowvec dv;
 	double objectiveFunctionValue = 0.0;
 	double valueAcqusitionFunction = 0.0;
+	rowvec gradientAcqusitionFunction;
 
 	double sigma = 0.0;
 	rowvec constraintValues;
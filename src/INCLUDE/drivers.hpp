@@ -88,6 +88,7 @@ public:
 	void checkSettingsForSurrogateModelTest(void) const;
 	void checkSettingsForDoE(void) const;
 	void checkSettingsForOptimization(void) const;
+	void checkSettingsForDataConversion(void) const;
 
 
 	void checkIfObjectiveFunctionNameIsDefined(void) const;
@@ -110,6 +111,7 @@ public:
 
 	void checkConsistencyOfConfigParams(void) const;
 	void readConfigFile(void);
+	void setRandomSeedFromConfigFile(void) const;
 
 
 
@@ -139,11 +141,15 @@ public:
 
 	Optimizer setOptimizationStudy(void);
 	void setOptimizationFeatures(Optimizer &) const;
+	void setNumberOfJobSlots(Optimizer &) const;
+	void setEvaluationSandbox(Optimizer &) const;
+	void setEvaluationCache(Optimizer &) const;
 
 	void runOptimization(void);
 	void runSurrogateModelTest(void);
 	void runDoE(void);
 	void generateDoESamples(void);
+	void convertDataFile(void) const;
 
 
 
@@ -33,6 +33,8 @@
 
 
 #include<armadillo>
+#include<vector>
+#include<unordered_map>
 #include "bounds.hpp"
 #include "output.hpp"
 #include "general_purpose_optimizer.hpp"
@@ -107,6 +109,27 @@ public:
 
 
 
+/* binary indexed tree for sampling from weights that change, both operations are O(log N) */
+
+class FenwickTree{
+
+private:
+
+	std::vector<double> tree;
+	unsigned int size = 0;
+	unsigned int highestPowerOfTwo = 0;
+	double totalWeight = 0.0;
+
+public:
+
+	void initialize(const vec &weights);
+	void addToWeight(unsigned int index, double value);
+	double getTotalWeight(void) const;
+	unsigned int findIndexOfCumulativeWeight(double value) const;
+
+};
+
+
 class EAPopulation{
 
 
@@ -114,6 +137,12 @@ private:
 
 	std::vector<EAIndividual> population;
 
+	/* id -> order of the individual in the population */
+	std::unordered_map<unsigned int, unsigned int> orderOfId;
+
+	vec cumulativeReproductionProbabilities;
+	vec cumulativeDeathProbabilities;
+
 	double populationMinimum = LARGE;
 	double populationMaximum = -LARGE;
 	unsigned int idPopulationMinimum = 0;
@@ -126,6 +155,8 @@ private:
 	vec findPolynomialCoefficientsForQuadraticFitnessDistribution(void) const;
 	void updateFitnessValuesLinear();
 	void updateFitnessValuesQuadratic();
+	void removeIndividualWithoutUpdate(unsigned int order);
+	unsigned int findOrderByCumulativeProbability(const vec &cumulativeProbabilities) const;
 
 public:
 
@@ -133,9 +164,10 @@ public:
 	void setDimension(unsigned int);
 	unsigned int getSize(void) const;
 
-	void addIndividual(EAIndividual);
-	void addAGroupOfIndividuals(std::vector<EAIndividual> individualsToAdd);
-	void removeIndividual(unsigned int id);
+	void addIndividual(const EAIndividual &);
+	void addAGroupOfIndividuals(const std::vector<EAIndividual> &individualsToAdd);
+	void removeIndividual(unsigned int order);
+	void removeIndividuals(std::vector<unsigned int> orders);
 	unsigned int getIdOftheIndividual(unsigned int index) const;
 
 	EAIndividual getTheBestIndividual(void) const;
@@ -145,6 +177,7 @@ public:
 
 	int getIndividualOrderInPopulationById(unsigned int id) const;
 	unsigned int  getIndividualIdInPopulationByOrder(unsigned int order) const;
+	unsigned int  getMaximumId(void) const;
 
 	void print(void) const;
 
@@ -156,6 +189,7 @@ public:
 
 	EAIndividual pickUpARandomIndividualForReproduction(void) const;
 	unsigned int pickUpAnIndividualThatWillDie(void) const;
+	std::vector<unsigned int> pickUpIndividualsThatWillDie(unsigned int howMany) const;
 
 	void reset(void);
 	void writeToFile(std::string) const;
@@ -181,6 +215,7 @@ private:
 	unsigned int sizeOfInitialPopulation = 0;
 
 	unsigned int totalNumberOfGeneratedIndividuals = 0;
+	unsigned int idOfTheNextIndividual = 0;
 
 	unsigned int numberOfNewIndividualsInAGeneration = 0;
 	unsigned int numberOfDeathsInAGeneration = 0;
@@ -196,6 +231,8 @@ private:
 
 	double improvementFunction = 0.0;
 
+	unsigned int generateNewId(void);
+	virtual void prepareObjectiveFunctionForThreads(unsigned int numberOfThreads);
 	void callObjectiveFunctionForAGroup(std::vector<EAIndividual> &children);
 	void generateAGroupOfIndividualsForReproduction(
 			std::vector<EAIndividual> &children);
@@ -214,6 +251,7 @@ public:
 	void setMaximumNumberOfGeneratedIndividuals(unsigned int number);
 
 	void callObjectiveFunction(EAIndividual &individual);
+	unsigned int getNumberOfThreadsForEvaluation(void) const;
 
 
 	EAIndividual generateRandomIndividual(void);
@@ -0,0 +1,92 @@
+/*
+ * RoDeO, a Robust Design Optimization Package
+ *
+ * Copyright (C) 2015-2021 Chair for Scientific Computing (SciComp), TU Kaiserslautern
+ * Homepage: http://www.scicomp.uni-kl.de
+ * Contact:  Prof. Nicolas R. Gauger (nicolas.gauger@scicomp.uni-kl.de) or Dr. Emre Özkaya (emre.oezkaya@scicomp.uni-kl.de)
+ *
+ * Lead developer: Emre Özkaya (SciComp, TU Kaiserslautern)
+ *
+ * This file is part of RoDeO
+ *
+ * RoDeO is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * RoDeO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details.
+ * You should have received a copy of the GNU
+ * General Public License along with CoDiPack.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors: Emre Özkaya, (SciComp, TU Kaiserslautern)
+ *
+ *
+ *
+ */
+
+#ifndef EVALUATION_CACHE_HPP
+#define EVALUATION_CACHE_HPP
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <cstdio>
+#include <unordered_map>
+
+
+/** Persistent cache of the outputs of the external executables.
+ *
+ * The key of an entry is built from the name of the function, the evaluation mode (primal, tangent, adjoint) and
+ * the quantized design vector (and the tangent direction). Each value is quantized to a mantissa of 40 bits and its
+ * binary exponent, so that designs which differ only by round-off share the same entry. The value of an entry is the
+ * output vector of the executable, i.e. the function value and the tangent or the gradient if available.
+ *
+ * The entries are appended to a binary file, which is read again when the cache is opened. File format:
+ *
+ *   "RODEOEC1", then records of: uint32 key length, key bytes, uint32 n, n doubles (native byte order)
+ *
+ * An incomplete record at the end of the file (e.g. after an interrupted run) is removed when the file is read.
+ *
+ */
+
+class EvaluationCache{
+
+private:
+
+	std::string filename;
+	FILE *fileAppend = NULL;
+
+	std::unordered_map<std::string, std::vector<double> > entries;
+
+	mutable std::mutex cacheMutex;
+
+	unsigned int numberOfEntriesReadFromFile = 0;
+
+	bool readFile(void);
+
+public:
+
+	EvaluationCache(std::string filename);
+	~EvaluationCache();
+
+	EvaluationCache(const EvaluationCache &) = delete;
+	EvaluationCache &operator=(const EvaluationCache &) = delete;
+
+	static std::string generateKey(const std::string &name, const std::string &mode, const std::vector<double> &values);
+
+	bool find(const std::string &key, std::vector<double> &values) const;
+	void add(const std::string &key, const std::vector<double> &values);
+
+	unsigned int getNumberOfEntries(void) const;
+	unsigned int getNumberOfEntriesReadFromFile(void) const;
+	std::string getFileName(void) const;
+
+};
+
+
+#endif
@@ -0,0 +1,79 @@
+/*
+ * RoDeO, a Robust Design Optimization Package
+ *
+ * Copyright (C) 2015-2021 Chair for Scientific Computing (SciComp), TU Kaiserslautern
+ * Homepage: http://www.scicomp.uni-kl.de
+ * Contact:  Prof. Nicolas R. Gauger (nicolas.gauger@scicomp.uni-kl.de) or Dr. Emre Özkaya (emre.oezkaya@scicomp.uni-kl.de)
+ *
+ * Lead developer: Emre Özkaya (SciComp, TU Kaiserslautern)
+ *
+ * This file is part of RoDeO
+ *
+ * RoDeO is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * RoDeO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details.
+ * You should have received a copy of the GNU
+ * General Public License along with CoDiPack.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors: Emre Özkaya, (SciComp, TU Kaiserslautern)
+ *
+ *
+ *
+ */
+
+#ifndef EVALUATION_SANDBOX_HPP
+#define EVALUATION_SANDBOX_HPP
+
+#include <string>
+#include <atomic>
+
+
+/** Scratch directories for the evaluations of the external executables.
+ *
+ * Every job gets its own directory under the root directory. If a template directory is set, its content
+ * (input files, meshes, scripts) is copied to the job directory. The design vector file and the output file
+ * are then written and read in the job directory, so that several evaluations can run at the same time.
+ * After the evaluation the job directory is either removed or moved to the archive directory.
+ *
+ */
+
+class EvaluationSandbox{
+
+private:
+
+	std::string rootDirectory = "sandbox";
+	std::string templateDirectory;
+	std::string archiveDirectory;
+
+	std::atomic<unsigned int> jobCounter;
+
+public:
+
+	EvaluationSandbox();
+
+	EvaluationSandbox(const EvaluationSandbox &) = delete;
+	EvaluationSandbox &operator=(const EvaluationSandbox &) = delete;
+
+	void setRootDirectory(std::string);
+	void setTemplateDirectory(std::string);
+	void setArchiveDirectory(std::string);
+
+	std::string getRootDirectory(void) const;
+	bool isArchiveOn(void) const;
+
+	std::string createJobDirectory(std::string jobName);
+	void copyTemplateToDirectory(std::string directory) const;
+	void finalizeJobDirectory(std::string directory) const;
+
+};
+
+
+#endif
@@ -61,6 +61,8 @@ protected:
 	double (*calculateObjectiveFunction)(vec);
 
 	bool ifObjectiveFunctionIsSet = false;
+	/* true if the objective function can be called concurrently, e.g. a function without state set by setObjectiveFunction */
+	bool ifObjectiveFunctionIsReentrant = false;
 	bool ifProblemNameIsSet = false;
 	bool ifFilenameOptimizationHistoryIsSet = false;
 	bool ifFilenameWarmStartIsSet = false;
@@ -70,6 +72,7 @@ protected:
 
 
 	unsigned int numberOfThreads = 1;
+	bool ifNumberOfThreadsIsSet = false;
 
 
 
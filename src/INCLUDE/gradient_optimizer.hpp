@@ -63,6 +63,8 @@ private:
 
 	bool ifGradientFunctionIsSet = false;
 	bool areFiniteDifferenceApproximationsToBeUsed = false;
+	bool ifBFGSUpdateIsOn = false;
+	bool ifLineSearchHasFailed = false;
 
 
 
@@ -75,7 +77,9 @@ private:
 	double tolerance = 10E-6;
 	double epsilonForFiniteDifferences = 0.001;
 	double maximumStepSize = 0.0;
-	unsigned int maximumNumberOfIterationsInLineSearch  = 10;
+	unsigned int maximumNumberOfIterationsInLineSearch  = 50;
+
+	mat inverseHessian;
 
 	vec (*calculateGradientFunction)(vec);
 
@@ -89,6 +93,11 @@ private:
 	vec calculateCentralFiniteDifferences(designPoint &input);
 	vec calculateForwardFiniteDifferences(designPoint &input);
 
+	vec projectToBounds(vec) const;
+	vec calculateSearchDirection(void);
+	void updateInverseHessian(const designPoint &previousIterate);
+	double calculateProjectedGradientNorm(const designPoint &) const;
+
 public:
 
 	GradientOptimizer();
@@ -115,6 +124,7 @@ public:
 	void setMaximumNumberOfIterationsInLineSearch(unsigned int);
 	void setFiniteDifferenceMethod(string);
 	void setEpsilonForFiniteDifference(double);
+	void setBFGSUpdateOn(void);
 
 	void evaluateObjectiveFunction(designPoint &);
 	void evaluateGradientFunction(designPoint &);
@@ -129,6 +139,8 @@ public:
 	void optimize(void);
 
 	double getOptimalObjectiveFunctionValue(void) const;
+	vec getOptimalDesignVector(void) const;
+	unsigned int getNumberOfFunctionEvaluations(void) const;
 
 };
 
@@ -43,6 +43,7 @@
 #include "design.hpp"
 #include "linear_solver.hpp"
 #include "ea_optimizer.hpp"
+#include "gradient_optimizer.hpp"
 #include "correlation_functions.hpp"
 using namespace arma;
 
@@ -56,8 +57,11 @@ private:
 	vec R_inv_ys_min_beta;
 	vec R_inv_I;
 	vec R_inv_ys;
+	vec L_inv_I;
 	vec vectorOfOnes;
 
+	double dotITRinvI = 0.0;
+
 
 	CholeskySystem linearSystemCorrelationMatrix;
 	SVDSystem      linearSystemCorrelationMatrixSVD;
@@ -67,18 +71,31 @@ private:
 
 	bool ifUsesLinearRegression = false;
 	bool ifCorrelationFunctionIsInitialized = false;
+	bool ifUsesGradientBasedTraining = false;
+
+	unsigned int numberOfStartingPointsForGradientBasedTraining = 10;
 
 	double genErrorKriging;
 
 	LinearModel linearModel;
 
+	void updateModelWithTheLastSample(void);
+
 	ExponentialCorrelationFunction correlationFunction;
 
 
 	double yMin = -LARGE;
 
+	/* fictitious outputs of the pending samples (designs that are still being evaluated) */
+	vec outputValuesPendingSamples;
+
+	/* state of the model without the pending samples */
+	ExponentialCorrelationFunction correlationFunctionWithoutPendingSamples;
+	CholeskySystem linearSystemWithoutPendingSamples;
+
 	void updateWithNewData(void);
 	void updateModelParams(void);
+	void updateBeta0AndSigmaSquared(void);
 
 
 public:
@@ -102,20 +119,30 @@ public:
 	vec getHyperParameters(void) const;
 
 	void train(void);
+	void trainWithGradientBasedMultiStart(void);
+	void setGradientBasedTrainingOn(void);
+	void setGradientBasedTrainingOff(void);
+	void setNumberOfStartingPointsForGradientBasedTraining(unsigned int);
 
-	double interpolateWithGradients(rowvec x) const ;
+	void interpolateWithGradients(rowvec xp, double *f_tilde, double *ssqr, rowvec &gradientEstimate, rowvec &gradientVariance) const;
 	double interpolate(rowvec x) const ;
 	void interpolateWithVariance(rowvec xp,double *f_tilde,double *ssqr) const;
+	void interpolateBatch(const mat &X, vec &estimates, vec *variances = NULL) const;
 
 
 	void addNewSampleToData(rowvec newsample);
 	void addNewLowFidelitySampleToData(rowvec newsample);
 
+	void addPendingSample(rowvec xp, double fictitiousValue);
+	void removePendingSamples(void);
+	unsigned int getNumberOfPendingSamples(void) const;
+
 	double getyMin(void) const;
 
 	vec getRegressionWeights(void) const;
 	void setRegressionWeights(vec weights);
 	void setEpsilon(double inp);
+	void setMaximumMemoryForDistanceCache(double);
 	void setLinearRegressionOn(void);
 	void setLinearRegressionOff(void);
 
@@ -126,11 +153,14 @@ public:
 
 
 	void updateModelWithNewData(void);
+	void updateModelWithNewSample(const rowvec &);
+	void updateModelWithSharedData(const SurrogateModelData &);
 	void updateAuxilliaryFields(void);
 	void updateAuxilliaryFieldsWithSVDMethod(void);
 	void checkAuxilliaryFields(void) const;
 
 	double calculateLikelihoodFunction(vec);
+	double calculateLikelihoodFunctionAndGradient(vec, vec &);
 
 
 };
@@ -141,13 +171,41 @@ class KrigingHyperParameterOptimizer : public EAOptimizer{
 private:
 
 	double calculateObjectiveFunctionInternal(vec& input);
+	void prepareObjectiveFunctionForThreads(unsigned int numberOfThreads);
+
+	/* the likelihood evaluation modifies the model, therefore each thread uses its own copy */
+	std::vector<KrigingModel> KrigingModelsForCalculations;
+
+
+
+public:
+
+	KrigingHyperParameterOptimizer();
+
+	void initializeKrigingModelObject(const KrigingModel &);
+	bool ifModelObjectIsSet = false;
+
+
+
+};
+
+
+class KrigingHyperParameterGradientOptimizer : public GradientOptimizer{
+
+private:
+
+	double calculateObjectiveFunctionInternal(vec& input);
+	vec calculateGradientFunctionInternal(vec input);
 	KrigingModel  KrigingModelForCalculations;
 
+	/* the gradient is computed together with the likelihood and reused */
+	vec lastEvaluatedInput;
+	vec lastEvaluatedGradient;
 
 
 public:
 
-	void initializeKrigingModelObject(KrigingModel);
+	void initializeKrigingModelObject(const KrigingModel &);
 	bool ifModelObjectIsSet = false;
 
 
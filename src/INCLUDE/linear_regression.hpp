@@ -57,7 +57,7 @@ public:
 	void loadHyperParameters(void);
 	void train(void);
 	double interpolate(rowvec x) const ;
-	double interpolateWithGradients(rowvec x) const ;
+	void interpolateWithGradients(rowvec xp, double *f_tilde, double *ssqr, rowvec &gradientEstimate, rowvec &gradientVariance) const;
 	void interpolateWithVariance(rowvec xp,double *f_tilde,double *ssqr) const;
 
 	void addNewSampleToData(rowvec newsample);
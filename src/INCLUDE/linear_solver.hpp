@@ -60,7 +60,7 @@ public:
 
 	SVDSystem(){};
 
-	void setMatrix(mat);
+	void setMatrix(const mat &);
 	void factorize();
 	vec solveLinearSystem(vec &rhs) const;
 	double calculateLogAbsDeterminant(void) const;
@@ -78,13 +78,9 @@ private:
 	unsigned int dimension = 0;
 	mat A;
 	mat L;
-	mat U;
 	bool ifFactorizationIsDone = false;
 	bool ifMatrixIsSet = false;
 
-	vec forwardSubstitution(vec rhs) const;
-	vec backwardSubstitution(vec rhs) const;
-
 public:
 
 
@@ -100,12 +96,19 @@ public:
 	void setMatrix(mat);
 	mat getMatrix(void) const;
 	void factorize();
+	void addRowAndColumn(vec);
 	bool isFactorizationDone(void);
 
 	double calculateDeterminant(void);
 	double calculateLogDeterminant(void);
 
-	vec solveLinearSystem(vec) const;
+	vec solveLinearSystem(const vec &) const;
+	mat solveLinearSystem(const mat &) const;
+
+	mat calculateInverse(void) const;
+
+	mat forwardSubstitution(const mat &rhs) const;
+	mat backwardSubstitution(const mat &rhs) const;
 
 
 
@@ -86,6 +86,8 @@ public:
 	void setWeights(vec wIn);
 
 	double calculateNorm(const rowvec &) const;
+	double calculateNorm(const subview_row<double> &) const;
+	double calculateDistance(const double *x_i, const double *x_j) const;
 	void findOptimalWeights();
 	void findOptimalWeightsGradientBased(vec);
 
@@ -105,13 +107,18 @@ class WeightedL1NormOptimizer : public EAOptimizer{
 private:
 
 	double calculateObjectiveFunctionInternal(vec& input);
-	WeightedL1Norm  weightedL1NormForCalculations;
+	void prepareObjectiveFunctionForThreads(unsigned int numberOfThreads);
+
+	/* the evaluation sets the weights of the norm, therefore each thread uses its own copy */
+	std::vector<WeightedL1Norm> weightedL1NormsForCalculations;
 
 	bool ifWeightedL1NormForCalculationsIsSet = false;
 
 
 public:
 
+	WeightedL1NormOptimizer();
+
 	bool isWeightedL1NormForCalculationsSet(void) const;
 
 	void initializeWeightedL1NormObject(WeightedL1Norm);
@@ -103,6 +103,7 @@ public:
 
 	void setNameOfHyperParametersFile(string filename);
 	void setNumberOfTrainingIterations(unsigned int);
+	void setGradientBasedTrainingOn(void);
 
 	void setinputFileNameHighFidelityData(string);
 	void setinputFileNameLowFidelityData(string);
@@ -149,6 +150,7 @@ public:
 	double interpolateError(rowvec x) const;
 
 	void interpolateWithVariance(rowvec xp,double *f_tilde,double *ssqr) const;
+	void interpolateBatch(const mat &X, vec &estimates, vec *variances = NULL) const;
 
 	void addNewSampleToData(rowvec newsample);
 	void addNewLowFidelitySampleToData(rowvec newsample);
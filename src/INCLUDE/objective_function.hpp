@@ -32,6 +32,8 @@
 #define OBJECTIVE_FUNCTION_HPP
 
 #include <fstream>
+#include <memory>
+#include <vector>
 #include <armadillo>
 #include "kriging_training.hpp"
 #include "tgek.hpp"
@@ -40,6 +42,9 @@
 #include "multi_level_method.hpp"
 #include "design.hpp"
 #include "output.hpp"
+#include "simulation_worker.hpp"
+#include "evaluation_sandbox.hpp"
+#include "evaluation_cache.hpp"
 
 
 
@@ -64,6 +69,8 @@ public:
 
 	bool ifMultiLevel = false;
 	bool ifDefined = false;
+	bool ifWorkerMode = false;
+	bool ifGradientBasedModelTraining = false;
 
 
 	SURROGATE_MODEL modelHiFi  = ORDINARY_KRIGING;
@@ -123,6 +130,20 @@ protected:
 
 	double yMin = 0.0;
 
+	/* used only in the worker mode, one worker per job slot, shared by the copies of the object */
+	std::vector< std::shared_ptr<SimulationWorker> > workers;
+
+	rowvec callWorker(const Design &d, unsigned int slot) const;
+
+	/* if set, every evaluation runs in its own job directory */
+	std::shared_ptr<EvaluationSandbox> sandbox;
+
+	/* if set, the outputs of the executable are stored and reused for the same design */
+	std::shared_ptr<EvaluationCache> cache;
+
+	void assignAndCacheOutputs(Design &d, const rowvec &outputs) const;
+	unsigned int getNumberOfOutputValues(void) const;
+
 
 
 public:
@@ -181,6 +202,8 @@ public:
 
 	void setFileNameDesignVector(std::string);
 	std::string getFileNameDesignVector(void) const;
+	std::string getFileNameOutput(void) const;
+	bool checkIfWorkerModeIsOn(void) const;
 	std::string getFileNameTrainingData(void) const;
 
 
@@ -188,26 +211,51 @@ public:
 
 
 	void calculateExpectedImprovement(DesignForBayesianOptimization &designCalculated) const;
+	double calculateExpectedImprovementValue(double ftilde, double sigma) const;
+	void calculateExpectedImprovementWithGradient(DesignForBayesianOptimization &designCalculated) const;
 	void calculateProbabilityOfImprovement(DesignForBayesianOptimization &designCalculated) const;
 
 	void evaluateDesign(Design &d);
 	void evaluateObjectiveFunction(void);
 
+	void setEvaluationSandbox(std::shared_ptr<EvaluationSandbox>);
+	void setEvaluationCache(std::shared_ptr<EvaluationCache>);
+	std::string generateCacheKey(const Design &d) const;
+	bool findOutputsInTheCache(Design &d) const;
+
+	void setNumberOfJobSlots(unsigned int);
+	unsigned int getNumberOfJobSlots(void) const;
+	bool evaluateDesignOnJobSlot(Design &d, unsigned int slot, std::string workingDirectory = "") const;
+	void evaluateDesignInDirectory(Design &d, std::string workingDirectory) const;
+	void writeDesignVariablesToDirectory(const Design &d, std::string workingDirectory) const;
+	void runExecutableInDirectory(std::string workingDirectory) const;
+	void readOutputDesignFromDirectory(Design &d, std::string workingDirectory) const;
+	void stopWorkers(void);
+
 
 	void writeDesignVariablesToFile(Design &d) const;
+	void writeDesignVariablesToFile(const Design &d, std::string filename) const;
 
 
 	rowvec readOutput(unsigned int) const;
+	rowvec readOutputFromFile(std::string filename, unsigned int howMany) const;
 	void readOutputDesign(Design &) const;
+	virtual void assignOutputsToDesign(Design &, const rowvec &) const;
 
 
 
 	void addDesignToData(Design &d);
 	void addLowFidelityDesignToData(Design &d);
 
+	bool checkIfPendingDesignsAreSupported(void) const;
+	void addPendingDesign(rowvec x, bool ifConstantLiar);
+	void removePendingDesigns(void);
+
 	bool checkIfGradientAvailable(void) const;
 	double interpolate(rowvec x) const;
 	pair<double, double> interpolateWithVariance(rowvec x) const;
+	void interpolateBatchWithVariance(const mat &X, vec &estimates, vec &sigmas) const;
+	void interpolateWithGradients(rowvec x, double *ftilde, double *sigma, rowvec &gradientEstimate, rowvec &gradientSigma) const;
 
 	void print(void) const;
 	std::string getExecutionCommand(void) const;
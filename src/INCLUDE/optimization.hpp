@@ -68,6 +68,8 @@ private:
 
 	std::vector<DesignForBayesianOptimization> theMostPromisingDesigns;
 
+	std::shared_ptr<EvaluationSandbox> sandbox;
+
 
 	bool isHistoryFileInitialized = false;
 
@@ -93,6 +95,20 @@ private:
 	void findTheGlobalOptimalDesign(void);
 	void initializeBoundsForAcquisitionFunctionMaximization();
 
+	rowvec findTheNextDesignToEvaluate(void);
+
+	void EfficientGlobalOptimizationAsynchronous(void);
+	void prepareEvaluationsOnJobSlots(unsigned int howManySlots);
+	void evaluateDesignOnJobSlot(Design &d, unsigned int slot) const;
+	void evaluateConstraintsOnJobSlot(Design &d, unsigned int slot, std::string workingDirectory, bool ifObjectiveFunctionOutputIsAvailable) const;
+	bool checkIfFileBasedEvaluationsExist(void) const;
+	std::string getDirectoryJobSlot(unsigned int slot) const;
+	void addEvaluatedDesignToTheStudy(Design &d);
+
+	std::string getFileNameDoEResult(unsigned int sampleID) const;
+	void evaluateDoESample(rowvec dv, unsigned int sampleID, unsigned int slot) const;
+	Design readDoESample(rowvec dv, unsigned int sampleID) const;
+
 public:
 
 	std::string name;
@@ -110,6 +126,9 @@ public:
 
 	unsigned int iterGradientEILoop = 100;
 
+	unsigned int numberOfJobSlots = 1;
+	bool ifJobSlotDirectoriesAreUsed = false;
+
 
 	bool ifVisualize = false;
 	bool ifDisplay = false;
@@ -118,6 +137,7 @@ public:
 	bool ifSurrogatesAreInitialized = false;
 	bool ifZoomInDesignSpaceIsAllowed = false;
 	bool ifreduceTrainingDataZoomIn = false;
+	bool ifConstantLiarIsUsed = false;
 
 
 	OutputDevice output;
@@ -168,6 +188,12 @@ public:
 	void setHowOftenTrainModels(unsigned int value);
 	void setHowOftenZoomIn(unsigned int value);
 
+	void setNumberOfJobSlots(unsigned int value);
+	void setEvaluationSandbox(std::shared_ptr<EvaluationSandbox>);
+	void setEvaluationCache(std::shared_ptr<EvaluationCache>);
+	void setConstantLiarOn(void);
+	void setConstantLiarOff(void);
+
 
 	void zoomInDesignSpace(void);
 
@@ -190,6 +216,7 @@ public:
 
 
 	void addPenaltyToAcqusitionFunctionForConstraints(DesignForBayesianOptimization &) const;
+	void addPenaltyToAcqusitionFunctionForConstraintsWithGradient(DesignForBayesianOptimization &) const;
 
 	void computeConstraintsandPenaltyTerm(Design &);
 
@@ -214,6 +241,7 @@ public:
 	rowvec calculateGradientOfAcqusitionFunction(DesignForBayesianOptimization &) const;
 	DesignForBayesianOptimization MaximizeAcqusitionFunctionGradientBased(DesignForBayesianOptimization ) const;
 	void findTheMostPromisingDesign(unsigned int howManyDesigns = 1);
+	DesignForBayesianOptimization findTheBestCandidateWithinBounds(const vec &lb, const vec &ub, unsigned long long seed) const;
 	DesignForBayesianOptimization getDesignWithMaxExpectedImprovement(void) const;
 
 	rowvec generateRandomRowVectorAroundASample(void);
@@ -35,6 +35,9 @@
 
 using namespace arma;
 
+void setRandomSeed(unsigned long long seed);
+unsigned long long getRandomSeed(void);
+
 int generateRandomInt(int a, int b);
 int generateRandomInt(uvec indices);
 
@@ -42,17 +45,18 @@ double generateRandomDouble(double a, double b);
 void generateRandomDoubleArray(double *xp,double a, double b, unsigned int dim);
 
 
-rowvec generateRandomRowVector(vec lb, vec ub);
+rowvec generateRandomRowVector(const vec &lb, const vec &ub);
 rowvec generateRandomRowVector(double lb, double ub, unsigned int dim);
 
-vec generateRandomVector(vec lb, vec ub);
+vec generateRandomVector(const vec &lb, const vec &ub);
 vec generateRandomVector(double lb, double ub, unsigned int dim);
 
-void generateRandomVector(vec lb, vec ub, unsigned int dim, double *x);
+void generateRandomVector(const vec &lb, const vec &ub, unsigned int dim, double *x);
 
-mat generateRandomMatrix(unsigned int Nrows, vec lb, vec ub);
+mat generateRandomMatrix(unsigned int Nrows, const vec &lb, const vec &ub);
 
 double generateRandomDoubleFromNormalDist(double xs, double xe, double sigma_factor);
+double generateRandomDoubleFromCounter(unsigned long long seed, unsigned long long counter, double a, double b);
 
 
 void generateKRandomIntegers(uvec &numbers, unsigned int N, unsigned int k);
@@ -0,0 +1,91 @@
+/*
+ * RoDeO, a Robust Design Optimization Package
+ *
+ * Copyright (C) 2015-2021 Chair for Scientific Computing (SciComp), TU Kaiserslautern
+ * Homepage: http://www.scicomp.uni-kl.de
+ * Contact:  Prof. Nicolas R. Gauger (nicolas.gauger@scicomp.uni-kl.de) or Dr. Emre Özkaya (emre.oezkaya@scicomp.uni-kl.de)
+ *
+ * Lead developer: Emre Özkaya (SciComp, TU Kaiserslautern)
+ *
+ * This file is part of RoDeO
+ *
+ * RoDeO is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * RoDeO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details.
+ * You should have received a copy of the GNU
+ * General Public License along with CoDiPack.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors: Emre Özkaya, (SciComp, TU Kaiserslautern)
+ *
+ *
+ *
+ */
+
+#ifndef SIMULATION_WORKER_HPP
+#define SIMULATION_WORKER_HPP
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <sys/types.h>
+
+
+/** Runs an executable as a long-lived worker process, instead of starting it once per evaluation.
+ *
+ * The executable is started directly (without a shell) with the environment variable RODEO_WORKER_MODE=1,
+ * its stdin and stdout are connected to pipes. Each request and each reply is a length-prefixed message in
+ * native byte order:
+ *
+ *   uint32_t n, followed by n doubles
+ *
+ * A request contains the design vector (followed by the tangent direction in the tangent mode), the reply contains
+ * the same values that would be written to the output file. A request with n = 0 asks the worker to terminate.
+ *
+ */
+
+class SimulationWorker{
+
+private:
+
+	std::string executable;
+
+	pid_t processId = -1;
+	int fileDescriptorRequest = -1;
+	int fileDescriptorReply   = -1;
+
+	std::mutex workerMutex;
+
+	bool ifRunning = false;
+
+	unsigned int timeoutForTerminationInMilliseconds = 5000;
+
+	bool writeMessage(const std::vector<double> &values);
+	bool readMessage(std::vector<double> &values);
+
+public:
+
+	SimulationWorker();
+	~SimulationWorker();
+
+	SimulationWorker(const SimulationWorker &) = delete;
+	SimulationWorker &operator=(const SimulationWorker &) = delete;
+
+	bool start(const std::string &executableToRun);
+	void stop(void);
+	void setTimeoutForTermination(unsigned int milliseconds);
+	bool isRunning(void) const;
+
+	bool evaluate(const std::vector<double> &input, std::vector<double> &output);
+
+};
+
+
+#endif
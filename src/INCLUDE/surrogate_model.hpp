@@ -97,6 +97,9 @@ public:
 	virtual void readData(void);
 	virtual void normalizeData(void);
 
+	void setData(const SurrogateModelData &);
+	const SurrogateModelData &getData(void) const;
+
 	void printData(void) const;
 
 	void checkRawData(void) const;
@@ -124,7 +127,7 @@ public:
 
 	unsigned int getDimension(void) const;
 	unsigned int getNumberOfSamples(void) const;
-	mat getRawData(void) const;
+	const subview<double> getRawData(void) const;
 
 
 
@@ -134,6 +137,7 @@ public:
 	virtual void setNameOfInputFile(string filename) = 0;
 	virtual void setNameOfHyperParametersFile(string filename) = 0;
 	virtual void setNumberOfTrainingIterations(unsigned int) = 0;
+	virtual void setGradientBasedTrainingOn(void);
 
 	virtual void initializeSurrogateModel(void) = 0;
 	virtual void printSurrogateModel(void) const = 0;
@@ -144,12 +148,14 @@ public:
 	virtual void train(void) = 0;
 	virtual double interpolate(rowvec x) const = 0;
 	virtual void interpolateWithVariance(rowvec xp,double *f_tilde,double *ssqr) const = 0;
+	virtual void interpolateBatch(const mat &X, vec &estimates, vec *variances = NULL) const;
+	virtual void interpolateWithGradients(rowvec xp, double *f_tilde, double *ssqr, rowvec &gradientEstimate, rowvec &gradientVariance) const;
 
 	virtual void addNewSampleToData(rowvec newsample) = 0;
 	virtual void addNewLowFidelitySampleToData(rowvec newsample) = 0;
 
 
-	vec interpolateVector(mat X) const;
+	vec interpolateVector(const mat &X) const;
 
 	void tryOnTestData(void);
 
@@ -158,8 +164,8 @@ public:
 
 	void saveTestResults(void) const;
 
-	mat getX(void) const;
-	vec gety(void) const;
+	const subview<double> getX(void) const;
+	const subview_col<double> gety(void) const;
 	rowvec getRowX(unsigned int index) const;
 	rowvec getRowXRaw(unsigned int index) const;
 
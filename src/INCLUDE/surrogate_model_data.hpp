@@ -35,6 +35,7 @@
 #include "output.hpp"
 #include "bounds.hpp"
 #include<string>
+#include<memory>
 
 #define ARMA_DONT_PRINT_ERRORS
 #include <armadillo>
@@ -42,6 +43,26 @@
 using namespace arma;
 using std::string;
 
+/* matrices of the training samples, a copy of SurrogateModelData shares them until one of the copies modifies them.
+ * The matrices keep spare rows for new samples, each copy of the data uses only its first numberOfSamples rows */
+
+struct SurrogateModelSampleMatrices{
+
+	mat rawData;
+	mat X;
+	mat Xraw;
+	mat gradient;
+	mat differentiationDirections;
+
+	/* transposed copies, each sample is a contiguous column (see getPointerToRowX) */
+	mat XSampleMajor;
+	mat differentiationDirectionsSampleMajor;
+
+	/* rows written so far, by the copy of the data that has appended the last sample */
+	unsigned int numberOfRows = 0;
+
+};
+
 class SurrogateModelData{
 
 protected:
@@ -51,14 +72,11 @@ protected:
 	unsigned int dimension = 0;
 
 
-	mat rawData;
-	mat X;
-	mat Xraw;
-	mat gradient;
-	vec y;
+	std::shared_ptr<SurrogateModelSampleMatrices> samples;
 
+	/* spare rows as in the sample matrices */
+	vec y;
 	vec directionalDerivatives;
-	mat differentiationDirections;
 
 	mat XrawTest;
 	mat XTest;
@@ -69,6 +87,12 @@ protected:
 	OutputDevice outputToScreen;
 	Bounds boxConstraints;
 
+	SurrogateModelSampleMatrices &getSampleMatricesForModification(void);
+	SurrogateModelSampleMatrices &getSampleMatricesForAppending(void);
+
+	void updateSampleMajorMatrices(void);
+	void reserveRowForTheNewSample(mat &);
+	void appendColumnToSampleMajorMatrix(mat &, const rowvec &);
 
 public:
 
@@ -95,7 +119,7 @@ public:
 
 	void setBoxConstraints(Bounds);
 	void setBoxConstraintsFromData(void);
-	Bounds getBoxConstraints(void) const;
+	const Bounds &getBoxConstraints(void) const;
 
 
 	void assignDimensionFromData(void);
@@ -114,6 +138,7 @@ public:
 
 	bool isDataNormalized(void) const;
 	bool isDataRead(void) const;
+	bool isDataSharedWith(const SurrogateModelData &) const;
 
 
 	unsigned int getNumberOfSamples(void) const;
@@ -122,7 +147,8 @@ public:
 	unsigned int getDimension(void) const;
 	void setDimension(unsigned int);
 
-	mat getRawData(void) const;
+	/* views of the first numberOfSamples rows, no copy */
+	const subview<double> getRawData(void) const;
 
 	rowvec getRowX(unsigned int index) const;
 	rowvec getRowXTest(unsigned int index) const;
@@ -130,25 +156,41 @@ public:
 	rowvec getRowGradient(unsigned int index) const;
 	rowvec getRowDifferentiationDirection(unsigned int index) const;
 
-	mat getInputMatrix(void) const;
+	/* views of the rows, no copy */
+	const subview_row<double> getRowXView(unsigned int index) const;
+	const subview_row<double> getRowXRawView(unsigned int index) const;
+	const subview_row<double> getRowGradientView(unsigned int index) const;
+	const subview_row<double> getRowDifferentiationDirectionView(unsigned int index) const;
+
+	/* contiguous storage of a sample (dimension values) */
+	const double *getPointerToRowX(unsigned int index) const;
+	const double *getPointerToRowDifferentiationDirection(unsigned int index) const;
+
+	const subview<double> getInputMatrix(void) const;
 
 	rowvec getRowXRaw(unsigned int index) const;
 	rowvec getRowXRawTest(unsigned int index) const;
 
-	vec getOutputVector(void) const;
+	const subview_col<double> getOutputVector(void) const;
 	void setOutputVector(vec);
 	vec getOutputVectorTest(void) const;
 	double getMinimumOutputVector(void) const;
 	double getMaximumOutputVector(void) const;
 
-	mat getGradientMatrix(void) const;
-	vec getDirectionalDerivativesVector(void) const;
+	const subview<double> getGradientMatrix(void) const;
+	const subview_col<double> getDirectionalDerivativesVector(void) const;
 
 	double getScalingFactorForOutput(void) const;
 
 	void readData(string);
+	void readDataBinary(string);
 	void readDataTest(string);
 
+	void appendSample(const rowvec &);
+
+	static void appendSampleToFileAsynchronously(const rowvec &, string);
+	static void waitForPendingWritesToFile(string);
+
 
 	void print(void) const;
 
@@ -58,4 +58,8 @@
 //#define TEST_GRADIENTOPTIMIZER
 //#define TEST_LINEAR_SOLVER
 //#define OPTIMIZATION_TEST
+//#define TEST_SIMULATION_WORKER
+//#define TEST_EVALUATION_SANDBOX
+//#define TEST_EVALUATION_CACHE
+//#define TEST_BINARY_DATA_FILE
 
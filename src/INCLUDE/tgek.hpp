@@ -51,7 +51,7 @@ private:
 	   	vec vectorOfOnes;
 
 	   	vec w;
-	   	mat weightMatrix;
+	   	vec weightsOfEquations;   /* diagonal of the weighting matrix, N function values then N derivatives */
 	   	vec sampleWeights;
 
 	   	mat Phi;
@@ -59,6 +59,10 @@ private:
 	   	vec ydot;
 	   	vec Wydot;
 
+	   	/* samples and hyperparameters of the last Phi matrix, used to extend it when a sample is appended */
+	   	mat XPhiMatrix;
+	   	vec hyperParametersPhiMatrix;
+
 	   	SVDSystem  linearSystemCorrelationMatrixSVD;
 
 	   	double beta0 = 0.0;
@@ -77,10 +81,12 @@ private:
 
 	   	uvec indicesDifferentiatedBasisFunctions;
 
-	   	std::string filenameTrainingDataAuxModel = "auxiliaryData.csv";
-
 	void calculatePhiEntriesForFunctionValues(void);
 	void calculatePhiEntriesForDerivatives(void);
+	void calculatePhiEntriesForDifferentiatedBasisFunctions(void);
+	bool checkIfPhiMatrixCanBeExtended(void) const;
+	void extendPhiMatrixWithTheLastSample(void);
+	void updateWeightsOfBasisFunctions(void);
 	void generateRhsForRBFs(void);
 	void resetDataObjects(void);
 	void updateModelWithNewData(void);
@@ -95,6 +101,7 @@ public:
 		void setNameOfInputFile(string filename);
 		void setNameOfHyperParametersFile(string filename);
 		void setNumberOfTrainingIterations(unsigned int);
+		void setGradientBasedTrainingOn(void);
 		void setNumberOfDifferentiatedBasisFunctionsUsed(unsigned int n);
 
 		void initializeSurrogateModel(void);
@@ -109,6 +116,7 @@ public:
 		void train(void);
 		double interpolate(rowvec x) const;
 		void interpolateWithVariance(rowvec xp,double *f_tilde,double *ssqr) const ;
+		void interpolateBatch(const mat &X, vec &estimates, vec *variances = NULL) const;
 //		void calculateExpectedImprovement(CDesignExpectedImprovement &designCalculated) const;
 		void addNewSampleToData(rowvec newsample);
 		void addNewLowFidelitySampleToData(rowvec newsample);
@@ -122,6 +130,7 @@ public:
 
 		void trainTheta(void);
 		void prepareTrainingDataForTheKrigingModel(void);
+		const KrigingModel &getAuxiliaryModel(void) const;
 		void generateWeightingMatrix(void);
 		void generateSampleWeights(void);
 
@@ -79,8 +79,8 @@ int main(int argc, char* argv[]){
 
 
 
-	/* initialize random seed*/
-	srand (time(NULL));
+	/* initialize random seed, RANDOM_SEED in the config file overrides it */
+	setRandomSeed(time(NULL));
 
 
 	changeDirectoryToRodeoHome();
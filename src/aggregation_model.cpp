@@ -69,6 +69,12 @@ void AggregationModel::setNumberOfTrainingIterations(unsigned int nIters){
 
 }
 
+void AggregationModel::setGradientBasedTrainingOn(void){
+
+	krigingModel.setGradientBasedTrainingOn();
+
+}
+
 void AggregationModel::setNameOfHyperParametersFile(std::string label){
 
 	assert(isNotEmpty(label));
@@ -151,11 +157,17 @@ void AggregationModel::initializeSurrogateModel(void){
 
 	unsigned int dim = data.getDimension();
 
+	/* the Kriging model shares the training data, the data file is not read again */
+
 	krigingModel.setGradientsOn();
-	krigingModel.readData();
-	krigingModel.setBoxConstraints(data.getBoxConstraints());
+	krigingModel.setData(data);
+
+	if(!krigingModel.ifNormalized){
+
+		krigingModel.setBoxConstraints(data.getBoxConstraints());
+		krigingModel.normalizeData();
+	}
 
-	krigingModel.normalizeData();
 	krigingModel.initializeSurrogateModel();
 
 
@@ -350,35 +362,35 @@ void AggregationModel::setRho(double value){
 
 double AggregationModel::calculateMinimumDistanceToNearestPoint(const rowvec &x, int index) const{
 
-	rowvec xNearestPoint    = data.getRowX(index);
-
-	rowvec xDiff = x - xNearestPoint;
-
-	return weightedL1norm.calculateNorm(xDiff);
+	return weightedL1norm.calculateDistance(x.memptr(), data.getPointerToRowX(index));
 
 }
 
 
 double AggregationModel::calculateDualModelEstimate(const rowvec &x, int index) const{
 
-	vec y = data.getOutputVector();
+	/* no copies of the data, x is mapped back to the original design space element by element */
 
-	double yNearestPoint = y(index);
+	const subview_col<double> y = data.getOutputVector();
+	const Bounds &boxConstraints = data.getBoxConstraints();
 
+	const subview_row<double> gradNearestPoint = data.getRowGradientView(index);
+	const subview_row<double> xNearestPointRaw = data.getRowXRawView(index);
 
-	rowvec gradNearestPoint = data.getRowGradient(index);
-	rowvec xNearestPointRaw = data.getRowXRaw(index);
+	unsigned int dim = x.size();
 
+	double sum = y(index);
 
-	Bounds boxConstraints = data.getBoxConstraints();
+	for(unsigned int k=0; k<dim; k++){
 
-	vec xmin = boxConstraints.getLowerBounds();
-	vec xmax = boxConstraints.getUpperBounds();
-	rowvec xp = normalizeRowVectorBack(x, xmin, xmax);
+		double xmin = boxConstraints.getLowerBound(k);
+		double xmax = boxConstraints.getUpperBound(k);
+		double xp = x(k)*dim * (xmax - xmin) + xmin;
 
-	rowvec xDiffRaw = xp - xNearestPointRaw;
+		sum += (xp - xNearestPointRaw(k))*gradNearestPoint(k);
+	}
 
-	return yNearestPoint+ dot(xDiffRaw,gradNearestPoint);
+	return sum;
 
 }
 
@@ -417,13 +429,40 @@ void AggregationModel::interpolateWithVariance(rowvec x, double *estimateAggrega
 
 
 
+}
+
+/* the Kriging part (and the variance) is evaluated in a single batch, the dual model point by point */
+
+void AggregationModel::interpolateBatch(const mat &X, vec &estimates, vec *variances) const{
+
+	unsigned int numberOfPoints = X.n_rows;
+
+	vec estimatesKrigingModel;
+	krigingModel.interpolateBatch(X, estimatesKrigingModel, variances);
+
+	estimates.set_size(numberOfPoints);
+
+#pragma omp parallel for schedule(static)
+	for(unsigned int i=0; i<numberOfPoints; i++){
+
+		rowvec x = X.row(i);
+
+		int indexNearestPoint = findNearestNeighbor(x);
+
+		double estimateDualModel = calculateDualModelEstimate(x,indexNearestPoint);
+
+		double w2 = calculateDualModelWeight(x,indexNearestPoint);
+		double w1 = 1.0 - w2;
+
+		estimates(i) = w1*estimatesKrigingModel(i) + w2 * estimateDualModel;
+	}
+
 }
 
 double AggregationModel::calculateDualModelWeight(const rowvec &x, int index) const{
 
 	double minimumDistance = calculateMinimumDistanceToNearestPoint(x,index);
-	rowvec gradNearestPoint = data.getRowGradient(index);
-	double normGradient = weightedL1norm.calculateNorm(gradNearestPoint);
+	double normGradient = weightedL1norm.calculateNorm(data.getRowGradientView(index));
 
 	return  exp(-rho*minimumDistance*normGradient);
 
@@ -484,11 +523,11 @@ unsigned int AggregationModel::findNearestNeighbor(const rowvec &xp) const{
 
 	unsigned int N = data.getNumberOfSamples();
 
-	for(unsigned int i=0; i<N; i++){
+	const double *x = xp.memptr();
 
-		rowvec xdiff = xp - data.getRowX(i);
+	for(unsigned int i=0; i<N; i++){
 
-		double L1distance = weightedL1norm.calculateNorm(xdiff);
+		double L1distance = weightedL1norm.calculateDistance(x, data.getPointerToRowX(i));
 
 		if(L1distance < minL1Distance){
 
@@ -517,10 +556,7 @@ void AggregationModel::addNewSampleToData(rowvec newSample){
 	bool flagTooClose=false;
 	for(unsigned int i=0; i<N; i++){
 
-		rowvec sample = data.getRowRawData(i);
-
-
-		if(checkifTooCLose(sample, newSample)) {
+		if(checkifTooCLose(data.getRowRawData(i), newSample)) {
 
 			flagTooClose = true;
 		}
@@ -529,9 +565,12 @@ void AggregationModel::addNewSampleToData(rowvec newSample){
 
 	if(!flagTooClose){
 
-		appendRowVectorToCSVData(newSample, filenameDataInput);
+		/* the file is written in the background, both models are updated with the data in memory */
+
+		SurrogateModelData::appendSampleToFileAsynchronously(newSample, filenameDataInput);
 
-		updateModelWithNewData();
+		data.appendSample(newSample);
+		krigingModel.updateModelWithSharedData(data);
 
 	}
 	else{
@@ -555,7 +594,7 @@ void AggregationModel::updateModelWithNewData(void){
 	readData();
 	normalizeData();
 
-	krigingModel.updateModelWithNewData();
+	krigingModel.updateModelWithSharedData(data);
 
 }
 
@@ -40,6 +40,10 @@
 #include <fstream>
 #include<algorithm>
 #include<cctype>
+#include <sys/stat.h>
+#include <ftw.h>
+#include <cstdio>
+#include <unistd.h>
 
 
 using std::string;
@@ -481,6 +485,84 @@ bool file_exist(const char *fileName)
 	return infile.good();
 }
 
+bool directory_exist(std::string directory){
+
+	struct stat info;
+
+	if(stat(directory.c_str(), &info) != 0) return false;
+
+	return S_ISDIR(info.st_mode);
+}
+
+/* creates a single directory, returns true also if the directory already exists */
+
+bool createDirectory(std::string directory){
+
+	assert(!directory.empty());
+
+	if(mkdir(directory.c_str(), 0755) == 0) return true;
+
+	return directory_exist(directory);
+}
+
+/* called by nftw for every entry, the contents of a directory are visited before the directory itself (FTW_DEPTH) */
+
+static int removeDirectoryEntry(const char *path, const struct stat *, int, struct FTW *){
+
+	return remove(path);
+}
+
+/* removes the directory tree without calling a shell, symbolic links are removed but not followed (FTW_PHYS) */
+
+void removeDirectory(std::string directory){
+
+	assert(!directory.empty());
+
+	if(!directory_exist(directory)) return;
+
+	nftw(directory.c_str(), removeDirectoryEntry, 64, FTW_DEPTH | FTW_PHYS);
+}
+
+/* returns the path relative to the current working directory as an absolute path */
+
+std::string getAbsolutePath(std::string path){
+
+	if(!path.empty() && path[0] == '/') return path;
+
+	char buffer[4096];
+
+	if(getcwd(buffer, sizeof(buffer)) == NULL){
+
+		std::cout<<"ERROR: Current working directory cannot be determined!\n";
+		abort();
+	}
+
+	std::string workingDirectory(buffer);
+
+	if(path.empty() || path == ".") return workingDirectory;
+
+	if(path.compare(0,2,"./") == 0) path = path.substr(2);
+
+	return workingDirectory + "/" + path;
+}
+
+/* returns the string as a single word for /bin/sh: in single quotes, a single quote is written as '\'' */
+
+std::string quoteForShell(std::string text){
+
+	std::string quoted = "'";
+
+	for(auto it = text.begin(); it != text.end(); it++){
+
+		if(*it == '\'') quoted += "'\\''";
+		else quoted += *it;
+	}
+
+	quoted += "'";
+
+	return quoted;
+}
+
 
 
 void readFileToaString(std::string filename, std::string & stringCompleteFile){
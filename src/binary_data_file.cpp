@@ -0,0 +1,412 @@
+/*
+ * RoDeO, a Robust Design Optimization Package
+ *
+ * Copyright (C) 2015-2021 Chair for Scientific Computing (SciComp), TU Kaiserslautern
+ * Homepage: http://www.scicomp.uni-kl.de
+ * Contact:  Prof. Nicolas R. Gauger (nicolas.gauger@scicomp.uni-kl.de) or Dr. Emre Özkaya (emre.oezkaya@scicomp.uni-kl.de)
+ *
+ * Lead developer: Emre Özkaya (SciComp, TU Kaiserslautern)
+ *
+ * This file is part of RoDeO
+ *
+ * RoDeO is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * RoDeO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details.
+ * You should have received a copy of the GNU
+ * General Public License along with CoDiPack.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors: Emre Özkaya, (SciComp, TU Kaiserslautern)
+ *
+ *
+ *
+ */
+
+#include "binary_data_file.hpp"
+#include "matrix_vector_operations.hpp"
+#include "auxiliary_functions.hpp"
+#include <cassert>
+#include <cstring>
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+struct BinaryDataFileHeader{
+
+	char magic[8];
+	uint32_t dimension;
+	uint32_t flags;
+	uint32_t numberOfColumns;
+	uint32_t unused;
+	uint64_t numberOfRows;
+	uint64_t capacity;
+	char padding[24];
+};
+
+static_assert(sizeof(BinaryDataFileHeader) == 64, "Unexpected size of the binary data file header");
+
+static const char binaryDataFileMagic[] = "RODEOBD1";
+
+static const uint32_t flagGradients              = 1;
+static const uint32_t flagDirectionalDerivatives = 2;
+static const uint32_t flagBoxConstraints         = 4;
+
+
+BinaryDataFile::BinaryDataFile(std::string name){
+
+	assert(isNotEmpty(name));
+	filename = name;
+}
+
+bool BinaryDataFile::checkIfBinaryDataFile(std::string name){
+
+	FILE *inputFile = fopen(name.c_str(), "rb");
+
+	if(inputFile == NULL) return false;
+
+	char magic[8];
+	size_t howManyRead = fread(magic, 1, 8, inputFile);
+	fclose(inputFile);
+
+	return (howManyRead == 8 && memcmp(magic, binaryDataFileMagic, 8) == 0);
+}
+
+void BinaryDataFile::setGradientsOn(void){
+
+	ifDataHasGradients = true;
+}
+
+void BinaryDataFile::setDirectionalDerivativesOn(void){
+
+	ifDataHasDirectionalDerivatives = true;
+}
+
+void BinaryDataFile::setBoxConstraints(Bounds bounds){
+
+	boxConstraints = bounds;
+}
+
+unsigned int BinaryDataFile::getDimension(void) const{
+	return dimension;
+}
+
+unsigned int BinaryDataFile::getNumberOfColumns(void) const{
+	return numberOfColumns;
+}
+
+unsigned long long BinaryDataFile::getNumberOfRows(void) const{
+	return numberOfRows;
+}
+
+unsigned long long BinaryDataFile::getCapacity(void) const{
+	return capacity;
+}
+
+bool BinaryDataFile::checkIfDataHasGradients(void) const{
+	return ifDataHasGradients;
+}
+
+bool BinaryDataFile::checkIfDataHasDirectionalDerivatives(void) const{
+	return ifDataHasDirectionalDerivatives;
+}
+
+Bounds BinaryDataFile::getBoxConstraints(void) const{
+	return boxConstraints;
+}
+
+size_t BinaryDataFile::getDataOffset(void) const{
+
+	return sizeof(BinaryDataFileHeader) + 2*dimension*sizeof(double);
+}
+
+unsigned int BinaryDataFile::calculateDimension(unsigned int numberOfColumnsData) const{
+
+	assert(!(ifDataHasGradients && ifDataHasDirectionalDerivatives));
+
+	if(ifDataHasGradients) return (numberOfColumnsData-1)/2;
+	if(ifDataHasDirectionalDerivatives) return (numberOfColumnsData-2)/2;
+
+	return numberOfColumnsData-1;
+}
+
+/* sets the members from the header and the box constraints in the buffer, returns false if the buffer is not a valid header */
+
+bool BinaryDataFile::assignHeader(const char *buffer, size_t size){
+
+	BinaryDataFileHeader header;
+
+	if(size < sizeof(header)) return false;
+
+	memcpy(&header, buffer, sizeof(header));
+
+	if(memcmp(header.magic, binaryDataFileMagic, 8) != 0) return false;
+	if(header.numberOfRows > header.capacity) return false;
+
+	dimension       = header.dimension;
+	numberOfColumns = header.numberOfColumns;
+	numberOfRows    = header.numberOfRows;
+	capacity        = header.capacity;
+
+	ifDataHasGradients              = (header.flags & flagGradients);
+	ifDataHasDirectionalDerivatives = (header.flags & flagDirectionalDerivatives);
+
+	if(size < getDataOffset()) return false;
+
+	boxConstraints.reset();
+
+	if(header.flags & flagBoxConstraints){
+
+		vec lowerBounds(dimension);
+		vec upperBounds(dimension);
+
+		memcpy(lowerBounds.memptr(), buffer + sizeof(header), dimension*sizeof(double));
+		memcpy(upperBounds.memptr(), buffer + sizeof(header) + dimension*sizeof(double), dimension*sizeof(double));
+
+		boxConstraints.setBounds(lowerBounds, upperBounds);
+	}
+
+	return true;
+}
+
+void BinaryDataFile::writeHeader(FILE *outputFile) const{
+
+	BinaryDataFileHeader header;
+	memset(&header, 0, sizeof(header));
+
+	memcpy(header.magic, binaryDataFileMagic, 8);
+	header.dimension       = dimension;
+	header.numberOfColumns = numberOfColumns;
+	header.numberOfRows    = numberOfRows;
+	header.capacity        = capacity;
+
+	if(ifDataHasGradients)              header.flags |= flagGradients;
+	if(ifDataHasDirectionalDerivatives) header.flags |= flagDirectionalDerivatives;
+
+	std::vector<double> bounds(2*dimension, 0.0);
+
+	if(boxConstraints.areBoundsSet() && boxConstraints.getDimension() == dimension){
+
+		header.flags |= flagBoxConstraints;
+
+		vec lowerBounds = boxConstraints.getLowerBounds();
+		vec upperBounds = boxConstraints.getUpperBounds();
+
+		std::copy(lowerBounds.begin(), lowerBounds.end(), bounds.begin());
+		std::copy(upperBounds.begin(), upperBounds.end(), bounds.begin() + dimension);
+	}
+
+	fseek(outputFile, 0, SEEK_SET);
+	fwrite(&header, sizeof(header), 1, outputFile);
+	if(dimension > 0) fwrite(bounds.data(), sizeof(double), bounds.size(), outputFile);
+
+}
+
+bool BinaryDataFile::readHeader(void){
+
+	FILE *inputFile = fopen(filename.c_str(), "rb");
+
+	if(inputFile == NULL) return false;
+
+	std::vector<char> buffer(sizeof(BinaryDataFileHeader));
+	size_t howManyRead = fread(buffer.data(), 1, buffer.size(), inputFile);
+
+	if(howManyRead == buffer.size()){
+
+		uint32_t dimensionInFile;
+		memcpy(&dimensionInFile, buffer.data() + 8, sizeof(uint32_t));
+
+		buffer.resize(sizeof(BinaryDataFileHeader) + 2*dimensionInFile*sizeof(double));
+		howManyRead += fread(buffer.data() + howManyRead, 1, buffer.size() - howManyRead, inputFile);
+	}
+
+	fclose(inputFile);
+
+	return assignHeader(buffer.data(), howManyRead);
+}
+
+/** Reads the data by mapping the file into memory, the columns are copied directly into the matrix.
+ *
+ * @return data matrix (number of rows x number of columns)
+ */
+
+mat BinaryDataFile::read(void){
+
+	int fileDescriptor = open(filename.c_str(), O_RDONLY);
+
+	if(fileDescriptor < 0){
+		abortWithErrorMessage("Cannot open the binary data file: " + filename);
+	}
+
+	struct stat fileStatus;
+	fstat(fileDescriptor, &fileStatus);
+	size_t fileSize = fileStatus.st_size;
+
+	void *mappedFile = NULL;
+	if(fileSize > 0) mappedFile = mmap(NULL, fileSize, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+	close(fileDescriptor);
+
+	if(mappedFile == NULL || mappedFile == MAP_FAILED){
+		abortWithErrorMessage("Cannot map the binary data file: " + filename);
+	}
+
+	const char *buffer = static_cast<const char *>(mappedFile);
+
+	if(!assignHeader(buffer, fileSize) || fileSize < getDataOffset() + numberOfColumns*capacity*sizeof(double)){
+
+		munmap(mappedFile, fileSize);
+		abortWithErrorMessage("The binary data file is not valid: " + filename);
+	}
+
+	mat data(numberOfRows, numberOfColumns);
+
+	for(unsigned int j=0; j<numberOfColumns; j++){
+
+		const char *column = buffer + getDataOffset() + j*capacity*sizeof(double);
+		memcpy(data.colptr(j), column, numberOfRows*sizeof(double));
+	}
+
+	munmap(mappedFile, fileSize);
+
+	return data;
+}
+
+/** Writes the data to a new file (an existing file is replaced).
+ *
+ * @param[in] data: data matrix, the dimension follows from the number of columns and the flags
+ * @param[in] capacityToReserve: number of rows to reserve for the samples appended later (optional)
+ */
+
+void BinaryDataFile::write(const mat &data, unsigned long long capacityToReserve){
+
+	assert(data.n_cols > 0);
+
+	unsigned int dimensionOfData = calculateDimension(data.n_cols);
+
+	if(boxConstraints.areBoundsSet() && boxConstraints.getDimension() != dimensionOfData){
+		abortWithErrorMessage("Dimension of the box constraints does not match with the data: " + filename);
+	}
+
+	dimension = dimensionOfData;
+	numberOfColumns = data.n_cols;
+	numberOfRows = data.n_rows;
+	unsigned long long capacityMinimum = minimumCapacity;
+	capacity = std::max(std::max(numberOfRows, capacityToReserve), capacityMinimum);
+
+	/* written to a temporary file first, an interrupted write does not destroy the existing data */
+
+	std::string filenameTemporary = filename + ".tmp";
+
+	FILE *outputFile = fopen(filenameTemporary.c_str(), "wb");
+
+	if(outputFile == NULL){
+		abortWithErrorMessage("Cannot open the binary data file: " + filenameTemporary);
+	}
+
+	writeHeader(outputFile);
+
+	for(unsigned int j=0; j<numberOfColumns; j++){
+
+		fseek(outputFile, getDataOffset() + j*capacity*sizeof(double), SEEK_SET);
+		fwrite(data.colptr(j), sizeof(double), numberOfRows, outputFile);
+	}
+
+	fflush(outputFile);
+
+	/* unused part of the columns, the file is extended with zeros */
+
+	if(ftruncate(fileno(outputFile), getDataOffset() + numberOfColumns*capacity*sizeof(double)) != 0){
+		fclose(outputFile);
+		abortWithErrorMessage("Cannot resize the binary data file: " + filenameTemporary);
+	}
+
+	fclose(outputFile);
+
+	if(rename(filenameTemporary.c_str(), filename.c_str()) != 0){
+		abortWithErrorMessage("Cannot rename the binary data file: " + filenameTemporary);
+	}
+
+}
+
+void BinaryDataFile::appendRow(const rowvec &row){
+
+	mat rowToAppend = row;
+	appendRows(rowToAppend);
+}
+
+/** Appends samples in place. If the capacity of the file is not enough, the file is written again with
+ * twice the size. A file that does not exist is created.
+ *
+ * @param[in] rows: samples to append, the number of columns must be the same as in the file
+ */
+
+void BinaryDataFile::appendRows(const mat &rows){
+
+	if(rows.n_rows == 0) return;
+
+	if(!file_exist(filename)){
+
+		write(rows);
+		return;
+	}
+
+	if(!readHeader()){
+		abortWithErrorMessage("The binary data file is not valid: " + filename);
+	}
+
+	if(rows.n_cols != numberOfColumns){
+		abortWithErrorMessage("Number of columns does not match with the binary data file: " + filename);
+	}
+
+	if(numberOfRows + rows.n_rows > capacity){
+
+		mat data = read();
+		data.insert_rows(data.n_rows, rows);
+		write(data, 2*data.n_rows);
+		return;
+	}
+
+	FILE *outputFile = fopen(filename.c_str(), "r+b");
+
+	if(outputFile == NULL){
+		abortWithErrorMessage("Cannot open the binary data file: " + filename);
+	}
+
+	for(unsigned int j=0; j<numberOfColumns; j++){
+
+		fseek(outputFile, getDataOffset() + (j*capacity + numberOfRows)*sizeof(double), SEEK_SET);
+		fwrite(rows.colptr(j), sizeof(double), rows.n_rows, outputFile);
+	}
+
+	fflush(outputFile);
+
+	/* the new rows become visible only after the values are written */
+
+	numberOfRows += rows.n_rows;
+	writeHeader(outputFile);
+
+	fclose(outputFile);
+
+}
+
+void BinaryDataFile::importFromCSV(std::string filenameCSV){
+
+	mat data = readMatFromCVSFile(filenameCSV);
+	write(data);
+}
+
+void BinaryDataFile::exportToCSV(std::string filenameCSV){
+
+	mat data = read();
+	saveMatToCVSFile(data, filenameCSV);
+}
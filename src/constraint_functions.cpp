@@ -92,6 +92,8 @@ void ConstraintDefinition::print(void) const{
 	std::cout<< "Path = " << path << "\n";
 	std::cout<< "Surrogate model = " << modelHiFi << "\n";
 	std::cout<< "Multilevel = "<<ifMultiLevel<<"\n";
+	std::cout<< "Worker mode = "<<ifWorkerMode<<"\n";
+	std::cout<< "Gradient based model training = "<<ifGradientBasedModelTraining<<"\n";
 
 	if(ifMultiLevel){
 		std::cout<< "Low fidelity model = " << "\n";
@@ -119,6 +121,8 @@ void ConstraintFunction::setParametersByDefinition(ConstraintDefinition definiti
 	definition.modelHiFi = definitionConstraint.modelHiFi;
 	definition.modelLowFi = definitionConstraint.modelLowFi;
 	definition.ifMultiLevel = definitionConstraint.ifMultiLevel;
+	definition.ifWorkerMode = definitionConstraint.ifWorkerMode;
+	definition.ifGradientBasedModelTraining = definitionConstraint.ifGradientBasedModelTraining;
 	definition.name = definitionConstraint.name;
 	definition.nameHighFidelityTrainingData = definitionConstraint.nameHighFidelityTrainingData;
 	definition.nameLowFidelityTrainingData = definitionConstraint.nameLowFidelityTrainingData;
@@ -177,58 +181,40 @@ bool ConstraintFunction::checkFeasibility(double valueIn) const{
 }
 
 
-void ConstraintFunction::readOutputDesign(Design &d) const{
+void ConstraintFunction::assignOutputsToDesign(Design &d, const rowvec &outputs) const{
 
-	if(evaluationMode.compare("primal") == 0 ){
+	assert(outputs.size() >= getNumberOfOutputValues());
 
-		rowvec functionalValue(1);
-		functionalValue = readOutput(1);
+	if(evaluationMode.compare("primal") == 0 ){
 
 		assert(d.constraintTrueValues.size() > getID());
-		d.constraintTrueValues(getID()) = functionalValue(0);
+		d.constraintTrueValues(getID()) = outputs(0);
 	}
 
 	if(evaluationMode.compare("tangent") == 0 ){
 
-		rowvec resultBuffer(2);
-
-		resultBuffer = readOutput(2);
-		d.trueValue = resultBuffer(0);
-		d.tangentValue = resultBuffer(1);
+		d.trueValue = outputs(0);
+		d.tangentValue = outputs(1);
 	}
 
 	if(evaluationMode.compare("adjoint") == 0 ){
 
-		rowvec resultBuffer(1+dim);
-
-		resultBuffer = readOutput(1+dim);
-
 		int id = definitionConstraint.ID;
 		assert(id>=0);
 
-		d.constraintTrueValues(id) = resultBuffer(0);
+		d.constraintTrueValues(id) = outputs(0);
 
 		rowvec gradient(dim,fill::zeros);
 
 		for(unsigned int i=0; i<dim; i++){
 
-			gradient(i) = resultBuffer(i+1);
+			gradient(i) = outputs(i+1);
 		}
 		d.constraintGradients.push_back(gradient);
 	}
 
 }
 
-void ConstraintFunction::evaluateDesign(Design &d){
-
-	assert(d.designParameters.size() == dim);
-
-	writeDesignVariablesToFile(d);
-	evaluateObjectiveFunction();
-	readOutputDesign(d);
-
-}
-
 void ConstraintFunction::addDesignToData(Design &d){
 
 	assert((isNotEmpty(definition.nameHighFidelityTrainingData)));
@@ -36,6 +36,8 @@
 #include <iostream>
 #include <unistd.h>
 #include <cassert>
+#include <algorithm>
+#include <limits>
 
 #include "correlation_functions.hpp"
 #include "matrix_vector_operations.hpp"
@@ -601,6 +603,7 @@ void CorrelationFunctionBase::setInputSampleMatrix(mat input){
 
 	assert(input.empty() == false);
 	X = input;
+	XSampleMajor = trans(X);
 	N = X.n_rows;
 	dim = X.n_cols;
 	correlationMatrix = zeros<mat>(N,N);
@@ -609,6 +612,35 @@ void CorrelationFunctionBase::setInputSampleMatrix(mat input){
 
 }
 
+/** Appends a new sample to the input matrix and extends the correlation matrix by one row and column
+ * @param[in] xNew: new sample (normalized)
+ * @return last column of the extended correlation matrix
+ *
+ */
+
+vec CorrelationFunctionBase::addNewSampleToInputMatrix(const rowvec &xNew){
+
+	assert(isInputSampleMatrixSet());
+	assert(xNew.size() == dim);
+	assert(correlationMatrix.n_rows == N);
+
+	vec newColumn(N+1);
+	newColumn.head(N) = computeCorrelationVector(xNew);
+	newColumn(N) = 1.0 + epsilon;
+
+	X.insert_rows(N, xNew);
+	XSampleMajor.insert_cols(N, trans(xNew));
+
+	correlationMatrix.resize(N+1,N+1);
+	correlationMatrix.col(N) = newColumn;
+	correlationMatrix.row(N) = trans(newColumn);
+
+	N++;
+
+	return newColumn;
+
+}
+
 void CorrelationFunctionBase::setDimension(unsigned int input){
 
 	dim = input;
@@ -617,27 +649,70 @@ void CorrelationFunctionBase::setDimension(unsigned int input){
 
 
 
+/** Assembles the correlation matrix. Only the upper triangle is computed, tile by tile in parallel,
+ * using the sample major copy of X so that both samples of a pair are contiguous in memory
+ *
+ */
+
 void CorrelationFunctionBase::computeCorrelationMatrix(void){
 
 	assert(checkIfParametersAreSetProperly());
 	assert(isInputSampleMatrixSet());
+	assert(XSampleMajor.n_cols == N);
 
-	mat I = eye(N,N);
+	if(correlationMatrix.n_rows != N || correlationMatrix.n_cols != N){
 
-	correlationMatrix = I;
+		correlationMatrix.set_size(N,N);
+	}
 
-	for (unsigned int i = 0; i < N; i++) {
-		for (unsigned int j = i + 1; j < N; j++) {
+	int numberOfTiles = (N + tileSize - 1)/tileSize;
 
-			double correlation = computeCorrelation(X.row(i), X.row(j));
-			correlationMatrix (i, j) = correlation;
-			correlationMatrix (j, i) = correlation;
-		}
+#pragma omp parallel for schedule(dynamic) if(numberOfTiles > 1)
+	for(int jTile = 0; jTile < numberOfTiles; jTile++){
+
+		unsigned int jStart = jTile*tileSize;
+		unsigned int jEnd   = std::min(jStart + tileSize, N);
+
+		for(int iTile = 0; iTile <= jTile; iTile++){
+
+			unsigned int iStart = iTile*tileSize;
+			unsigned int iEnd   = std::min(iStart + tileSize, N);
+
+			for (unsigned int j = jStart; j < jEnd; j++) {
+
+				double *columnj  = correlationMatrix.colptr(j);
+
+				unsigned int iLast = std::min(iEnd, j);
+
+				for (unsigned int i = iStart; i < iLast; i++) {
 
+					columnj[i] = computeCorrelationOfSamplePair(i, j);
+				}
+			}
+		}
 	}
 
+	correlationMatrix.diag().fill(1.0 + epsilon);
+
+	/* copy the upper triangle to the lower triangle */
+	correlationMatrix = symmatu(correlationMatrix);
+
+}
+
+double CorrelationFunctionBase::computeCorrelationOfSamplePair(unsigned int i, unsigned int j) const{
+
+	return computeCorrelation(XSampleMajor.colptr(i), XSampleMajor.colptr(j));
 
-	correlationMatrix  += I*epsilon;
+}
+
+/* default implementation for the correlation functions that work on row vectors */
+
+double CorrelationFunctionBase::computeCorrelation(const double *x_i, const double *x_j) const{
+
+	rowvec xi(x_i, dim);
+	rowvec xj(x_j, dim);
+
+	return computeCorrelation(xi, xj);
 
 }
 
@@ -714,59 +789,111 @@ mat CorrelationFunctionBase::compute_d2CorrelationMatrix_dxk_dxl(unsigned int k,
 }
 
 
-void CorrelationFunctionBase::computeCorrelationMatrixDot(void){
+/** Assembles the correlation matrix of the gradient enhanced model, N(d+1) x N(d+1). The matrix is allocated once
+ * and filled with the (d+1) x (d+1) blocks of the sample pairs i<=j, tile by tile in parallel as in
+ * computeCorrelationMatrix. Since the matrix is symmetric, each block is also written to its transposed position.
+ *
+ * Layout: block row 0 is [R dR/dxj_0 ... dR/dxj_d-1], block row k+1 is [dR/dxi_k d2R/dxk_dx0 ... d2R/dxk_dxd-1]
+ */
 
+void CorrelationFunctionBase::computeCorrelationMatrixDot(void){
 
 	assert(checkIfParametersAreSetProperly());
 	assert(isInputSampleMatrixSet());
-	correlationMatrixDot.reset();
-	correlationMatrix.reset();
+	assert(XSampleMajor.n_cols == N);
 
-	for(unsigned int iRow=0; iRow<dim; iRow++){
+	unsigned int sizeOfBlock = dim+1;
+	unsigned int sizeOfMatrix = N*sizeOfBlock;
 
+	if(correlationMatrixDot.n_rows != sizeOfMatrix || correlationMatrixDot.n_cols != sizeOfMatrix){
 
-		if(iRow == 0){
+		correlationMatrixDot.set_size(sizeOfMatrix,sizeOfMatrix);
+	}
 
+	int numberOfTiles = (N + tileSize - 1)/tileSize;
 
-			computeCorrelationMatrix();
+#pragma omp parallel if(numberOfTiles > 1)
+	{
+		mat block(sizeOfBlock, sizeOfBlock);
 
-			correlationMatrixDot = correlationMatrix;
-			//			correlationMatrixDot.print();
+#pragma omp for schedule(dynamic)
+		for(int jTile = 0; jTile < numberOfTiles; jTile++){
 
-			for(unsigned int j=0; j<dim; j++){
+			unsigned int jStart = jTile*tileSize;
+			unsigned int jEnd   = std::min(jStart + tileSize, N);
 
-				mat Rdot = compute_dCorrelationMatrixdxj(j);
+			for(int iTile = 0; iTile <= jTile; iTile++){
 
-				joinMatricesByColumns(correlationMatrixDot,Rdot);
+				unsigned int iStart = iTile*tileSize;
+				unsigned int iEnd   = std::min(iStart + tileSize, N);
 
-			}
+				for (unsigned int j = jStart; j < jEnd; j++) {
 
-			//			correlationMatrixDot.print("correlationMatrixDot");
+					unsigned int iLast = std::min(iEnd, j+1);
 
+					for (unsigned int i = iStart; i < iLast; i++) {
 
-		}
-		else{
+						computeCorrelationBlockOfSamplePair(i, j, block);
 
-			mat Rdot = compute_dCorrelationMatrixdxi(iRow);
+						/* entry (k,l) of the block is at (kN+i, lN+j) and at the transposed position (lN+j, kN+i) */
 
-			for(unsigned int j=0; j<dim; j++){
+						for(unsigned int l=0; l<sizeOfBlock; l++){
 
-				mat Rdotdot = compute_d2CorrelationMatrix_dxk_dxl(iRow, j);
+							double *columnOfPair = correlationMatrixDot.colptr(l*N + j);
+							const double *columnOfBlock = block.colptr(l);
 
-				joinMatricesByColumns(Rdot,Rdotdot);
+							for(unsigned int k=0; k<sizeOfBlock; k++){
 
+								columnOfPair[k*N + i] = columnOfBlock[k];
+								correlationMatrixDot.at(l*N + j, k*N + i) = columnOfBlock[k];
+							}
+						}
+					}
+				}
 			}
+		}
+	}
 
+	for(unsigned int i=0; i<N; i++){
 
-			joinMatricesByRows(correlationMatrixDot,Rdot);
+		correlationMatrixDot(i,i) += epsilon;
+	}
 
-			//			correlationMatrixDot.print("correlationMatrixDot");
+	correlationMatrix = correlationMatrixDot.submat(0, 0, N-1, N-1);
 
-		}
+}
+
+/** Entries of the correlation matrix of the gradient enhanced model for the sample pair (i,j), see computeCorrelationMatrixDot.
+ * The default implementation evaluates each entry separately.
+ *
+ * @param[in] i, j: indices of the samples
+ * @param[out] block: (d+1) x (d+1), must be allocated
+ */
+
+void CorrelationFunctionBase::computeCorrelationBlockOfSamplePair(unsigned int i, unsigned int j, mat &block) const{
+
+	rowvec xi = X.row(i);
+	rowvec xj = X.row(j);
+
+	block(0,0) = computeCorrelationOfSamplePair(i, j);
+
+	for(unsigned int l=0; l<dim; l++){
+
+		block(0,l+1) = compute_dR_dxj(xi, xj, l);
+	}
+
+	for(unsigned int k=0; k<dim; k++){
+
+		block(k+1,0) = compute_dR_dxi(xi, xj, k);
 
+		for(unsigned int l=0; l<dim; l++){
 
+			block(k+1,l+1) = compute_d2R_dxl_dxk(xi, xj, k, l);
+		}
 	}
 
+}
+
 
 
 
@@ -779,11 +906,16 @@ vec CorrelationFunctionBase::computeCorrelationVector(const rowvec &xp) const{
 
 	assert(checkIfParametersAreSetProperly());
 	assert(isInputSampleMatrixSet());
+	assert(xp.size() == dim);
+
 	vec r(N);
 
+	const double *x = xp.memptr();
+
+#pragma omp parallel for schedule(static) if(N > 20*tileSize)
 	for(unsigned int i=0;i<N;i++){
 
-		r(i) = computeCorrelation(xp, X.row(i) );
+		r(i) = computeCorrelation(x, XSampleMajor.colptr(i));
 
 	}
 
@@ -794,6 +926,39 @@ vec CorrelationFunctionBase::computeCorrelationVector(const rowvec &xp) const{
 
 
 
+/** Computes the correlation vectors of many points at once
+ * @param[in] Xpoints: points (normalized), one point per row
+ * @return N x M matrix, column m is the correlation vector of the point m
+ *
+ */
+
+mat CorrelationFunctionBase::computeCorrelationMatrixForPoints(const mat &Xpoints) const{
+
+	assert(checkIfParametersAreSetProperly());
+	assert(isInputSampleMatrixSet());
+	assert(Xpoints.n_cols == dim);
+
+	unsigned int M = Xpoints.n_rows;
+
+	mat XpointsSampleMajor = trans(Xpoints);
+	mat correlations(N,M);
+
+#pragma omp parallel for schedule(static) if(M > 1)
+	for(unsigned int m=0; m<M; m++){
+
+		const double *x = XpointsSampleMajor.colptr(m);
+		double *columnm = correlations.colptr(m);
+
+		for(unsigned int i=0; i<N; i++){
+
+			columnm[i] = computeCorrelation(x, XSampleMajor.colptr(i));
+		}
+	}
+
+	return correlations;
+
+}
+
 void CorrelationFunctionBase::setEpsilon(double value){
 
 	assert(value>=0.0);
@@ -915,6 +1080,249 @@ double ExponentialCorrelationFunction::computeCorrelation(const rowvec &x_i, con
 	return correlation;
 }
 
+double ExponentialCorrelationFunction::computeCorrelation(const double *x_i, const double *x_j) const {
+
+	const double *thetaPtr = theta.memptr();
+	const double *gammaPtr = gamma.memptr();
+
+	double sum = 0.0;
+	for (unsigned int k = 0; k < dim; k++) {
+
+		double exponentialPart = pow(fabs(x_i[k] - x_j[k]), gammaPtr[k]);
+		sum += thetaPtr[k] * exponentialPart;
+	}
+
+	return exp(-sum);
+}
+
+/* uses the distance cache if it is available, R_ij = exp(-sum theta_k exp(gamma_k log|x_i(k)-x_j(k)|)) */
+
+double ExponentialCorrelationFunction::computeCorrelationOfSamplePair(unsigned int i, unsigned int j) const {
+
+	if(!ifDistanceCacheIsBuilt){
+
+		return CorrelationFunctionBase::computeCorrelationOfSamplePair(i,j);
+	}
+
+	assert(i<j);
+	assert(j<N);
+
+	const double *logDistance = logDistanceCache->data() + (size_t(j)*(j-1)/2 + i)*dim;
+	const double *thetaPtr = theta.memptr();
+	const double *gammaPtr = gamma.memptr();
+
+	double sum = 0.0;
+	for (unsigned int k = 0; k < dim; k++) {
+
+		sum += thetaPtr[k] * exp(gammaPtr[k]*logDistance[k]);
+	}
+
+	return exp(-sum);
+}
+
+/** Computes sum_{i<j} weights(i,j) dR_ij/dp for all hyperparameters p = (theta, gamma) using the current
+ * correlation matrix, where dR_ij/dtheta_k = -R_ij |dx_k|^gamma_k and dR_ij/dgamma_k = -R_ij theta_k |dx_k|^gamma_k log|dx_k|
+ * @param[in] weights: symmetric N x N matrix
+ *
+ */
+
+vec ExponentialCorrelationFunction::computeWeightedHyperParameterDerivatives(const mat &weights) const{
+
+	assert(weights.n_rows == N);
+	assert(weights.n_cols == N);
+	assert(correlationMatrix.n_rows == N);
+
+	const double logZero = -std::numeric_limits<double>::max();
+
+	vec derivatives(2*dim, fill::zeros);
+
+#pragma omp parallel
+	{
+		vec derivativesThread(2*dim, fill::zeros);
+		vec logDistance(dim);
+
+#pragma omp for schedule(dynamic)
+		for(unsigned int j=1; j<N; j++){
+
+			const double *xj = XSampleMajor.colptr(j);
+
+			for(unsigned int i=0; i<j; i++){
+
+				double weight = weights(i,j)*correlationMatrix(i,j);
+
+				if(weight == 0.0) continue;
+
+				if(ifDistanceCacheIsBuilt){
+
+					const double *logDistanceCached = logDistanceCache->data() + (size_t(j)*(j-1)/2 + i)*dim;
+
+					for(unsigned int k=0; k<dim; k++) logDistance(k) = logDistanceCached[k];
+				}
+				else{
+
+					const double *xi = XSampleMajor.colptr(i);
+
+					for(unsigned int k=0; k<dim; k++){
+
+						double distance = fabs(xi[k] - xj[k]);
+
+						if(distance > 0.0) logDistance(k) = log(distance);
+						else logDistance(k) = logZero;
+					}
+				}
+
+				for(unsigned int k=0; k<dim; k++){
+
+					double distancePowGamma = exp(gamma(k)*logDistance(k));
+
+					derivativesThread(k) -= weight*distancePowGamma;
+
+					if(logDistance(k) != logZero){
+
+						derivativesThread(k+dim) -= weight*theta(k)*distancePowGamma*logDistance(k);
+					}
+				}
+			}
+		}
+
+#pragma omp critical
+		{
+			derivatives += derivativesThread;
+		}
+	}
+
+	return derivatives;
+
+}
+
+/** Computes the derivatives of the correlation vector with respect to the point xp,
+ * dr_i/dx_k = -r_i theta_k gamma_k |dx_k|^(gamma_k-1) sign(dx_k) with dx_k = xp(k) - x_i(k)
+ * @param[in] xp: point (normalized)
+ * @param[in] r: correlation vector of xp
+ * @return N x dim matrix, row i is the gradient of r_i
+ *
+ */
+
+mat ExponentialCorrelationFunction::computeCorrelationVectorGradient(const rowvec &xp, const vec &r) const{
+
+	assert(xp.size() == dim);
+	assert(r.size() == N);
+
+	mat gradient(N, dim, fill::zeros);
+
+	for(unsigned int k=0; k<dim; k++){
+
+		double factor = theta(k)*gamma(k);
+
+		if(factor == 0.0) continue;
+
+		for(unsigned int i=0; i<N; i++){
+
+			double distance = xp(k) - XSampleMajor(k,i);
+
+			/* the derivative is not defined for gamma < 1 at zero distance, it is set to zero there */
+			if(distance == 0.0) continue;
+
+			double derivative = factor*pow(fabs(distance), gamma(k) - 1.0);
+
+			if(distance > 0.0) gradient(i,k) = -r(i)*derivative;
+			else gradient(i,k) = r(i)*derivative;
+		}
+	}
+
+	return gradient;
+
+}
+
+void ExponentialCorrelationFunction::setInputSampleMatrix(mat input){
+
+	CorrelationFunctionBase::setInputSampleMatrix(input);
+	clearDistanceCache();
+
+}
+
+vec ExponentialCorrelationFunction::addNewSampleToInputMatrix(const rowvec &xNew){
+
+	vec newColumn = CorrelationFunctionBase::addNewSampleToInputMatrix(xNew);
+
+	/* the cache is only used during the training, it is built again for the new samples when the training starts */
+	clearDistanceCache();
+
+	return newColumn;
+}
+
+void ExponentialCorrelationFunction::setMaximumMemoryForDistanceCache(double value){
+
+	assert(value >= 0.0);
+	maximumMemoryForDistanceCache = value;
+
+}
+
+/** Precomputes log|x_i(k) - x_j(k)| for all sample pairs, so that the correlation matrix can be assembled
+ * without recomputing the distances for each new set of hyperparameters. The cache is not built if it
+ * would need more memory than maximumMemoryForDistanceCache. Copies of the correlation function made after this
+ * call share the cache, it is freed when the last of them clears it.
+ *
+ */
+
+void ExponentialCorrelationFunction::buildDistanceCache(void){
+
+	assert(isInputSampleMatrixSet());
+
+	clearDistanceCache();
+
+	size_t numberOfPairs = size_t(N)*(N-1)/2;
+	double requiredMemory = double(numberOfPairs*dim*sizeof(double))/(1024.0*1024.0);
+
+	if(requiredMemory > maximumMemoryForDistanceCache){
+
+		std::cout<<"WARNING: Distance cache requires "<<requiredMemory<<" MB, it is not used!\n";
+		return;
+	}
+
+	/* log(0) is replaced by the most negative double, so that exp(gamma*log(0)) gives 0 for gamma>0 and 1 for gamma=0 */
+	const double logZero = -std::numeric_limits<double>::max();
+
+	auto cache = std::make_shared<std::vector<double> >(numberOfPairs*dim);
+
+#pragma omp parallel for schedule(dynamic)
+	for(unsigned int j=1; j<N; j++){
+
+		const double *xj = XSampleMajor.colptr(j);
+
+		for(unsigned int i=0; i<j; i++){
+
+			const double *xi = XSampleMajor.colptr(i);
+			double *logDistance = cache->data() + (size_t(j)*(j-1)/2 + i)*dim;
+
+			for(unsigned int k=0; k<dim; k++){
+
+				double distance = fabs(xi[k] - xj[k]);
+
+				if(distance > 0.0) logDistance[k] = log(distance);
+				else logDistance[k] = logZero;
+			}
+		}
+	}
+
+	logDistanceCache = cache;
+	ifDistanceCacheIsBuilt = true;
+
+}
+
+void ExponentialCorrelationFunction::clearDistanceCache(void){
+
+	logDistanceCache.reset();
+	ifDistanceCacheIsBuilt = false;
+
+}
+
+bool ExponentialCorrelationFunction::isDistanceCacheBuilt(void) const{
+
+	return ifDistanceCacheIsBuilt;
+
+}
+
 void ExponentialCorrelationFunction::initialize(void){
 
 	assert(dim>0);
@@ -1034,6 +1442,20 @@ double GaussianCorrelationFunctionForGEK::computeCorrelation(const rowvec &x_i,
 	return exp(-sum);
 }
 
+double GaussianCorrelationFunctionForGEK::computeCorrelation(const double *x_i, const double *x_j) const {
+
+	const double *thetaPtr = theta.memptr();
+
+	double sum = 0.0;
+	for (unsigned int k = 0; k < dim; k++) {
+
+		double difference = x_i[k] - x_j[k];
+		sum += thetaPtr[k] * difference * difference;
+	}
+
+	return exp(-sum);
+}
+
 /* basis function centered at xi and evaluated at xj */
 double GaussianCorrelationFunctionForGEK::computeCorrelation(unsigned int i, unsigned int j) const {
 
@@ -1072,6 +1494,25 @@ double GaussianCorrelationFunctionForGEK::computeCorrelationDot(unsigned int i,
 
 }
 
+/* same as above for points given as contiguous arrays of length dim */
+
+double GaussianCorrelationFunctionForGEK::computeCorrelationDot(const double *x_i, const double *x_j, const double *diffDirection) const {
+
+	const double *thetaPtr = theta.memptr();
+
+	double sumd = 0.0;
+	double sum  = 0.0;
+	for (unsigned int k = 0; k < dim; k++) {
+
+		double difference = x_i[k] - x_j[k];
+		sumd += -2.0*thetaPtr[k] * difference*diffDirection[k];
+		sum  += thetaPtr[k] * difference * difference;
+	}
+
+	return -1.0*exp(-sum)*sumd;
+
+}
+
 double GaussianCorrelationFunctionForGEK::computeCorrelationDot(const rowvec &x_i, const rowvec &x_j, const rowvec &diffDirection) const {
 
 	double sumd = 0.0;
@@ -1182,6 +1623,46 @@ double GaussianCorrelationFunctionForGEK::compute_d2R_dxl_dxk(const rowvec & xi,
 	return dx;
 }
 
+/* all entries of the block share the same exponential factor, it is evaluated once per pair */
+
+void GaussianCorrelationFunctionForGEK::computeCorrelationBlockOfSamplePair(unsigned int i, unsigned int j, mat &block) const{
+
+	const double *xi = XSampleMajor.colptr(i);
+	const double *xj = XSampleMajor.colptr(j);
+	const double *thetaPtr = theta.memptr();
+
+	/* 2 theta_k (xi_k - xj_k) */
+	vec twoThetaTimesDifference(dim);
+
+	double sum = 0.0;
+	for (unsigned int k = 0; k < dim; k++) {
+
+		double difference = xi[k] - xj[k];
+		sum += thetaPtr[k] * difference * difference;
+		twoThetaTimesDifference(k) = 2.0*thetaPtr[k]*difference;
+	}
+
+	double R = exp(-sum);
+
+	block(0,0) = R;
+
+	for(unsigned int l=0; l<dim; l++){
+
+		block(0,l+1) =  twoThetaTimesDifference(l)*R;
+		block(l+1,0) = -twoThetaTimesDifference(l)*R;
+	}
+
+	for(unsigned int l=0; l<dim; l++){
+		for(unsigned int k=0; k<dim; k++){
+
+			block(k+1,l+1) = -twoThetaTimesDifference(k)*twoThetaTimesDifference(l)*R;
+		}
+
+		block(l+1,l+1) += 2.0*thetaPtr[l]*R;
+	}
+
+}
+
 
 void GaussianCorrelationFunctionForGEK::computeCorrelationMatrixDotForrester(void) {
 
@@ -48,6 +48,7 @@
 #include "drivers.hpp"
 #include "configkey.hpp"
 #include "lhs.hpp"
+#include "binary_data_file.hpp"
 #define ARMA_DONT_PRINT_ERRORS
 #include <armadillo>
 
@@ -70,6 +71,8 @@ RoDeODriver::RoDeODriver(){
 
 	configKeysObjectiveFunction.add(ConfigKey("NUMBER_OF_TRAINING_ITERATIONS","int") );
 	configKeysObjectiveFunction.add(ConfigKey("MULTILEVEL_MODEL","string") );
+	configKeysObjectiveFunction.add(ConfigKey("WORKER_MODE","string") );
+	configKeysObjectiveFunction.add(ConfigKey("GRADIENT_BASED_MODEL_TRAINING","string") );
 
 
 	/* Keywords for constraints */
@@ -85,6 +88,8 @@ RoDeODriver::RoDeODriver(){
 	configKeysConstraintFunction.add(ConfigKey("NUMBER_OF_TRAINING_ITERATIONS","int") );
 	configKeysConstraintFunction.add(ConfigKey("MULTILEVEL_MODEL","string") );
 	configKeysConstraintFunction.add(ConfigKey("FILENAME_TRAINING_DATA","stringVector") );
+	configKeysConstraintFunction.add(ConfigKey("WORKER_MODE","string") );
+	configKeysConstraintFunction.add(ConfigKey("GRADIENT_BASED_MODEL_TRAINING","string") );
 
 
 
@@ -118,9 +123,25 @@ RoDeODriver::RoDeODriver(){
 
 	configKeys.add(ConfigKey("NUMBER_OF_ITERATIONS_FOR_EXPECTED_IMPROVEMENT_MAXIMIZATION","int") );
 
+	configKeys.add(ConfigKey("NUMBER_OF_JOB_SLOTS","int") );
+	configKeys.add(ConfigKey("PENDING_DESIGN_STRATEGY","string") );
+
+	configKeys.add(ConfigKey("EVALUATION_SANDBOX","string") );
+	configKeys.add(ConfigKey("SANDBOX_DIRECTORY","string") );
+	configKeys.add(ConfigKey("SANDBOX_TEMPLATE_DIRECTORY","string") );
+	configKeys.add(ConfigKey("SANDBOX_ARCHIVE_DIRECTORY","string") );
+	configKeys.add(ConfigKey("EVALUATION_CACHE","string") );
+	configKeys.add(ConfigKey("EVALUATION_CACHE_FILE","string") );
+
+	configKeys.add(ConfigKey("DATA_CONVERSION_INPUT_FILE","string") );
+	configKeys.add(ConfigKey("DATA_CONVERSION_OUTPUT_FILE","string") );
+	configKeys.add(ConfigKey("DATA_CONVERSION_DERIVATIVES","string") );
+
 	configKeys.add(ConfigKey("GENERATE_ONLY_SAMPLES","string") );
 	configKeys.add(ConfigKey("DOE_OUTPUT_FILENAME","string") );
 
+	configKeys.add(ConfigKey("RANDOM_SEED","int") );
+
 	configKeys.add(ConfigKey("DISCRETE_VARIABLES","doubleVector") );
 	configKeys.add(ConfigKey("DISCRETE_VARIABLES_VALUE_INCREMENTS","doubleVector") );
 
@@ -188,6 +209,28 @@ void RoDeODriver::readConfigFile(void){
 
 
 	checkConsistencyOfConfigParams();
+
+	setRandomSeedFromConfigFile();
+}
+
+/* the seed is set in main from the time, a fixed seed makes the runs reproducible */
+
+void RoDeODriver::setRandomSeedFromConfigFile(void) const{
+
+	if(configKeys.ifConfigKeyIsSet("RANDOM_SEED")){
+
+		int seed = configKeys.getConfigKeyIntValue("RANDOM_SEED");
+
+		if(seed < 0){
+			abortWithErrorMessage("RANDOM_SEED must be a non-negative integer");
+		}
+
+		if(ifDisplayIsOn()){
+			std::cout<<"Random seed = "<<seed<<"\n";
+		}
+
+		setRandomSeed(seed);
+	}
 }
 
 
@@ -366,6 +409,13 @@ void RoDeODriver::checkSettingsForOptimization(void) const{
 
 }
 
+void RoDeODriver::checkSettingsForDataConversion(void) const{
+
+	configKeys.abortifConfigKeyIsNotSet("DATA_CONVERSION_INPUT_FILE");
+	configKeys.abortifConfigKeyIsNotSet("DATA_CONVERSION_OUTPUT_FILE");
+
+}
+
 
 
 
@@ -393,6 +443,10 @@ void RoDeODriver::checkConsistencyOfConfigParams(void) const{
 		checkSettingsForOptimization();
 	}
 
+	if(type == "CONVERT_DATA"){
+		checkSettingsForDataConversion();
+	}
+
 }
 
 void RoDeODriver::checkIfProblemTypeIsSetProperly(void) const{
@@ -406,7 +460,7 @@ void RoDeODriver::checkIfProblemTypeIsSetProperly(void) const{
 	if(!ifProblemTypeIsValid){
 
 		std::cout<<"ERROR: Problem type is not valid, did you set PROBLEM_TYPE properly?\n";
-		std::cout<<"Valid problem types: OPTIMIZATION, DoE, SURROGATE_TEST\n";
+		std::cout<<"Valid problem types: OPTIMIZATION, DoE, SURROGATE_TEST, CONVERT_DATA\n";
 		abort();
 
 	}
@@ -415,7 +469,7 @@ void RoDeODriver::checkIfProblemTypeIsSetProperly(void) const{
 
 bool RoDeODriver::checkifProblemTypeIsValid(std::string s) const{
 
-	if (s == "DoE" || s == "DOE" || s == "OPTIMIZATION" || s == "Optimization" || s == "SURROGATE_TEST" ){
+	if (s == "DoE" || s == "DOE" || s == "OPTIMIZATION" || s == "Optimization" || s == "SURROGATE_TEST" || s == "CONVERT_DATA" ){
 
 		return true;
 	}
@@ -526,6 +580,20 @@ void RoDeODriver::parseConstraintDefinition(std::string inputString){
 	constraintFunctionDefinition.modelHiFi = getSurrogateModelID(surrogateModel);
 	constraintFunctionDefinition.nameHighFidelityTrainingData = filenameTrainingData;
 
+	std::string workerMode = configKeysConstraintFunction.getConfigKeyStringValue("WORKER_MODE");
+
+	if(checkIfOn(workerMode)){
+
+		constraintFunctionDefinition.ifWorkerMode = true;
+	}
+
+	std::string gradientBasedModelTraining = configKeysConstraintFunction.getConfigKeyStringValue("GRADIENT_BASED_MODEL_TRAINING");
+
+	if(checkIfOn(gradientBasedModelTraining)){
+
+		constraintFunctionDefinition.ifGradientBasedModelTraining = true;
+	}
+
 	std::string multilevel;
 	multilevel = configKeysConstraintFunction.getConfigKeyStringValue("MULTILEVEL_MODEL");
 
@@ -644,6 +712,20 @@ void RoDeODriver::parseObjectiveFunctionDefinition(std::string inputString){
 	objectiveFunction.modelHiFi = getSurrogateModelID(surrogateModel);
 
 
+	std::string workerMode = configKeysObjectiveFunction.getConfigKeyStringValue("WORKER_MODE");
+
+	if(checkIfOn(workerMode)){
+
+		objectiveFunction.ifWorkerMode = true;
+	}
+
+	std::string gradientBasedModelTraining = configKeysObjectiveFunction.getConfigKeyStringValue("GRADIENT_BASED_MODEL_TRAINING");
+
+	if(checkIfOn(gradientBasedModelTraining)){
+
+		objectiveFunction.ifGradientBasedModelTraining = true;
+	}
+
 	multilevel = configKeysObjectiveFunction.getConfigKeyStringValue("MULTILEVEL_MODEL");
 
 
@@ -877,7 +959,97 @@ void RoDeODriver::setOptimizationFeatures(Optimizer &optimizationStudy) const{
 
 	}
 
+	setNumberOfJobSlots(optimizationStudy);
+	setEvaluationSandbox(optimizationStudy);
+	setEvaluationCache(optimizationStudy);
+
+	if(configKeys.ifConfigKeyIsSet("PENDING_DESIGN_STRATEGY")){
+
+		std::string strategy = configKeys.getConfigKeyStringValue("PENDING_DESIGN_STRATEGY");
+
+		if(strategy == "CONSTANT_LIAR") optimizationStudy.setConstantLiarOn();
+		else if(strategy == "KRIGING_BELIEVER") optimizationStudy.setConstantLiarOff();
+		else abortWithErrorMessage("Unknown PENDING_DESIGN_STRATEGY, options are KRIGING_BELIEVER and CONSTANT_LIAR");
+	}
+
+
 
+}
+
+void RoDeODriver::setNumberOfJobSlots(Optimizer &optimizationStudy) const{
+
+	if(configKeys.ifConfigKeyIsSet("NUMBER_OF_JOB_SLOTS")){
+
+		int numberOfJobSlots = configKeys.getConfigKeyIntValue("NUMBER_OF_JOB_SLOTS");
+
+		if(numberOfJobSlots < 1){
+			abortWithErrorMessage("NUMBER_OF_JOB_SLOTS must be at least 1");
+		}
+
+		optimizationStudy.setNumberOfJobSlots(numberOfJobSlots);
+	}
+
+}
+
+void RoDeODriver::setEvaluationSandbox(Optimizer &optimizationStudy) const{
+
+	std::string sandboxOption = "OFF";
+
+	if(configKeys.ifConfigKeyIsSet("EVALUATION_SANDBOX")){
+
+		sandboxOption = configKeys.getConfigKeyStringValue("EVALUATION_SANDBOX");
+	}
+
+	if(checkIfOn(sandboxOption)){
+
+		std::shared_ptr<EvaluationSandbox> sandbox = std::make_shared<EvaluationSandbox>();
+
+		if(configKeys.ifConfigKeyIsSet("SANDBOX_DIRECTORY")){
+
+			sandbox->setRootDirectory(configKeys.getConfigKeyStringValue("SANDBOX_DIRECTORY"));
+		}
+
+		if(configKeys.ifConfigKeyIsSet("SANDBOX_TEMPLATE_DIRECTORY")){
+
+			sandbox->setTemplateDirectory(configKeys.getConfigKeyStringValue("SANDBOX_TEMPLATE_DIRECTORY"));
+		}
+
+		if(configKeys.ifConfigKeyIsSet("SANDBOX_ARCHIVE_DIRECTORY")){
+
+			sandbox->setArchiveDirectory(configKeys.getConfigKeyStringValue("SANDBOX_ARCHIVE_DIRECTORY"));
+		}
+
+		displayMessage("Evaluations run in the sandbox directory: " + sandbox->getRootDirectory());
+
+		optimizationStudy.setEvaluationSandbox(sandbox);
+	}
+
+}
+
+void RoDeODriver::setEvaluationCache(Optimizer &optimizationStudy) const{
+
+	std::string cacheOption = "OFF";
+
+	if(configKeys.ifConfigKeyIsSet("EVALUATION_CACHE")){
+
+		cacheOption = configKeys.getConfigKeyStringValue("EVALUATION_CACHE");
+	}
+
+	if(checkIfOn(cacheOption)){
+
+		std::string filename = "evaluationCache.bin";
+
+		if(configKeys.ifConfigKeyIsSet("EVALUATION_CACHE_FILE")){
+
+			filename = configKeys.getConfigKeyStringValue("EVALUATION_CACHE_FILE");
+		}
+
+		std::shared_ptr<EvaluationCache> cache = std::make_shared<EvaluationCache>(filename);
+
+		displayMessage("Evaluation cache file: " + filename + ", number of entries = " + std::to_string(cache->getNumberOfEntries()));
+
+		optimizationStudy.setEvaluationCache(cache);
+	}
 
 }
 
@@ -946,8 +1118,7 @@ void RoDeODriver::determineProblemDimensionAndBoxConstraintsFromTrainingData(voi
 
 
 
-	mat bufferData;
-	bufferData.load(fileName, csv_ascii);
+	mat bufferData = readMatFromCVSFile(fileName);
 
 	int dim;
 
@@ -1041,6 +1212,52 @@ Optimizer RoDeODriver::setOptimizationStudy(void) {
 }
 
 
+/** Converts a csv data file to a binary data file or vice versa, depending on the format of the input file.
+ * The derivative data in the file is set by DATA_CONVERSION_DERIVATIVES (GRADIENTS or TANGENTS), the box constraints
+ * are saved in the binary file if LOWER_BOUNDS and UPPER_BOUNDS are set.
+ */
+
+void RoDeODriver::convertDataFile(void) const{
+
+	std::string inputFile  = configKeys.getConfigKeyStringValue("DATA_CONVERSION_INPUT_FILE");
+	std::string outputFile = configKeys.getConfigKeyStringValue("DATA_CONVERSION_OUTPUT_FILE");
+
+	if(BinaryDataFile::checkIfBinaryDataFile(inputFile)){
+
+		displayMessage("Exporting the binary data file " + inputFile + " to " + outputFile);
+
+		BinaryDataFile dataFile(inputFile);
+		dataFile.exportToCSV(outputFile);
+		return;
+	}
+
+	BinaryDataFile dataFile(outputFile);
+
+	if(configKeys.ifConfigKeyIsSet("DATA_CONVERSION_DERIVATIVES")){
+
+		std::string derivatives = configKeys.getConfigKeyStringValue("DATA_CONVERSION_DERIVATIVES");
+
+		if(derivatives == "GRADIENTS") dataFile.setGradientsOn();
+		else if(derivatives == "TANGENTS") dataFile.setDirectionalDerivativesOn();
+		else abortWithErrorMessage("Unknown DATA_CONVERSION_DERIVATIVES, options are GRADIENTS and TANGENTS");
+	}
+
+	if(configKeys.ifConfigKeyIsSet("LOWER_BOUNDS") && configKeys.ifConfigKeyIsSet("UPPER_BOUNDS")){
+
+		vec lb = configKeys.getConfigKeyVectorDoubleValue("LOWER_BOUNDS");
+		vec ub = configKeys.getConfigKeyVectorDoubleValue("UPPER_BOUNDS");
+
+		dataFile.setBoxConstraints(Bounds(lb,ub));
+	}
+
+	displayMessage("Importing the csv file " + inputFile + " to the binary data file " + outputFile);
+
+	dataFile.importFromCSV(inputFile);
+
+	displayMessage("Number of samples = " + std::to_string(dataFile.getNumberOfRows()));
+
+}
+
 void RoDeODriver::generateDoESamples(void) {
 
 	vec lowerBounds = configKeys.getConfigKeyVectorDoubleValue("LOWER_BOUNDS");
@@ -1128,6 +1345,9 @@ void RoDeODriver::runDoE(void) {
 	configKeys.abortifConfigKeyIsNotSet("NUMBER_OF_DOE_SAMPLES");
 	int maximumNumberDoESamples = configKeys.getConfigKeyIntValue("NUMBER_OF_DOE_SAMPLES");
 
+	setNumberOfJobSlots(optimizationStudy);
+	setEvaluationSandbox(optimizationStudy);
+	setEvaluationCache(optimizationStudy);
 	optimizationStudy.performDoE(maximumNumberDoESamples,LHS);
 
 
@@ -1302,6 +1522,12 @@ int RoDeODriver::runDriver(void){
 	}
 
 
+	if(problemType == "CONVERT_DATA"){
+
+		convertDataFile();
+		return 0;
+	}
+
 	if(problemType == "DoE" || problemType == "DOE"){
 
 
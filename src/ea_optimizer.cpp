@@ -37,6 +37,9 @@
 #define ARMA_DONT_PRINT_ERRORS
 #include <armadillo>
 #include<cassert>
+#include<algorithm>
+#include<functional>
+#include<omp.h>
 
 using namespace arma;
 using namespace std;
@@ -196,6 +199,68 @@ void EAIndividual::initializeRandom(void){
 
 }
 
+void FenwickTree::initialize(const vec &weights){
+
+	size = weights.size();
+	tree.assign(size+1, 0.0);
+	totalWeight = 0.0;
+
+	/* O(N) construction, each node passes its sum to its parent */
+	for(unsigned int i=1; i<=size; i++){
+
+		tree[i] += weights(i-1);
+		totalWeight += weights(i-1);
+
+		unsigned int parent = i + (i & (~i+1));
+		if(parent <= size) tree[parent] += tree[i];
+	}
+
+	highestPowerOfTwo = 1;
+	while(2*highestPowerOfTwo <= size) highestPowerOfTwo *= 2;
+
+}
+
+void FenwickTree::addToWeight(unsigned int index, double value){
+
+	assert(index < size);
+
+	totalWeight += value;
+
+	for(unsigned int i=index+1; i<=size; i += (i & (~i+1))){
+
+		tree[i] += value;
+	}
+
+}
+
+double FenwickTree::getTotalWeight(void) const{
+
+	return totalWeight;
+}
+
+/* returns the smallest index whose cumulative weight is larger than value */
+unsigned int FenwickTree::findIndexOfCumulativeWeight(double value) const{
+
+	assert(size > 0);
+
+	unsigned int position = 0;
+
+	for(unsigned int step = highestPowerOfTwo; step > 0; step /= 2){
+
+		if(position + step <= size && tree[position + step] <= value){
+
+			position += step;
+			value -= tree[position];
+		}
+	}
+
+	/* value >= totalWeight can only happen due to round-off */
+	if(position >= size) position = size - 1;
+
+	return position;
+}
+
+
 void EAPopulation::setDimension(unsigned int value){
 
 	dimension = value;
@@ -208,7 +273,11 @@ unsigned int EAPopulation::getSize(void) const{
 
 }
 
-void EAPopulation::addIndividual(EAIndividual itemToAdd){
+void EAPopulation::addIndividual(const EAIndividual &itemToAdd){
+
+	bool ifIdIsNew = orderOfId.emplace(itemToAdd.getId(), population.size()).second;
+	assert(ifIdIsNew);
+	(void) ifIdIsNew;
 
 	population.push_back(itemToAdd);
 
@@ -220,7 +289,9 @@ void EAPopulation::addIndividual(EAIndividual itemToAdd){
 }
 
 
-void EAPopulation::addAGroupOfIndividuals(std::vector<EAIndividual> individualsToAdd){
+void EAPopulation::addAGroupOfIndividuals(const std::vector<EAIndividual> &individualsToAdd){
+
+	population.reserve(population.size() + individualsToAdd.size());
 
 	for(auto it = std::begin(individualsToAdd); it != std::end(individualsToAdd); ++it) {
 
@@ -230,11 +301,32 @@ void EAPopulation::addAGroupOfIndividuals(std::vector<EAIndividual> individualsT
 
 }
 
+/* the last individual takes the place of the removed one, the order of the other individuals does not change */
+void EAPopulation::removeIndividualWithoutUpdate(unsigned int order){
+
+	assert(order < getSize());
+
+	unsigned int id = population[order].getId();
+	unsigned int orderOfTheLastIndividual = getSize() - 1;
+
+	auto it = orderOfId.find(id);
+	if(it != orderOfId.end() && it->second == order) orderOfId.erase(it);
+
+	if(order != orderOfTheLastIndividual){
+
+		population[order] = std::move(population[orderOfTheLastIndividual]);
+		orderOfId[population[order].getId()] = order;
+	}
+
+	population.pop_back();
+
+}
+
 void EAPopulation::removeIndividual(unsigned int order){
 
 	unsigned int id = getIdOftheIndividual(order);
 
-	population.erase(population.begin() + order);
+	removeIndividualWithoutUpdate(order);
 
 	if(id == idPopulationMaximum || id == idPopulationMinimum){
 
@@ -242,6 +334,29 @@ void EAPopulation::removeIndividual(unsigned int order){
 	}
 }
 
+/* removes all individuals given by their orders, min and max are updated only once at the end */
+void EAPopulation::removeIndividuals(std::vector<unsigned int> orders){
+
+	/* removing from the back first, so that the orders that are still to be removed remain valid */
+	std::sort(orders.begin(), orders.end(), std::greater<unsigned int>());
+
+	bool ifMinOrMaxIsRemoved = false;
+
+	for(auto it = std::begin(orders); it != std::end(orders); ++it) {
+
+		unsigned int id = getIdOftheIndividual(*it);
+
+		if(id == idPopulationMaximum || id == idPopulationMinimum) ifMinOrMaxIsRemoved = true;
+
+		removeIndividualWithoutUpdate(*it);
+	}
+
+	if(ifMinOrMaxIsRemoved){
+
+		updatePopulationMinAndMax();
+	}
+}
+
 unsigned int EAPopulation::getIdOftheIndividual(unsigned int index) const{
 
 	assert(index < getSize());
@@ -270,20 +385,12 @@ EAIndividual EAPopulation::getTheWorstIndividual(void) const{
 
 int  EAPopulation::getIndividualOrderInPopulationById(unsigned int id) const{
 
-
-	unsigned int index = 0;
-	for(auto it = std::begin(population); it != std::end(population); ++it) {
-
-		if(id == it->getId()){
-
-			return index;
-		}
-
-		index++;
-	}
+	auto it = orderOfId.find(id);
 
 	/* if the id coud not be found return -1 as failure */
-	return -1;
+	if(it == orderOfId.end()) return -1;
+
+	return it->second;
 }
 
 unsigned int  EAPopulation::getIndividualIdInPopulationByOrder(unsigned int order) const{
@@ -293,6 +400,18 @@ unsigned int  EAPopulation::getIndividualIdInPopulationByOrder(unsigned int orde
 
 }
 
+unsigned int EAPopulation::getMaximumId(void) const{
+
+	unsigned int maximumId = 0;
+
+	for(auto it = std::begin(population); it != std::end(population); ++it) {
+
+		maximumId = std::max(maximumId, it->getId());
+	}
+
+	return maximumId;
+}
+
 void EAPopulation::print(void) const{
 
 	std::ios oldState(nullptr);
@@ -321,6 +440,9 @@ void EAPopulation::print(void) const{
 void EAPopulation::reset(void){
 
 	population.clear();
+	orderOfId.clear();
+	cumulativeReproductionProbabilities.reset();
+	cumulativeDeathProbabilities.reset();
 
 }
 
@@ -496,11 +618,18 @@ void EAPopulation::updateReproductionProbabilities(void){
 	assert(sumFitness > 0.0);
 
 
+	cumulativeReproductionProbabilities.set_size(getSize());
+
+	double probabilitySum = 0.0;
+	unsigned int i = 0;
 	for(auto it = std::begin(population); it != std::end(population); ++it) {
 
 		double reproductionProbability = it->getFitnessValue()/sumFitness;
 		it->setReproductionProbabilityValue(reproductionProbability);
 
+		probabilitySum += reproductionProbability;
+		cumulativeReproductionProbabilities(i) = probabilitySum;
+		i++;
 	}
 
 
@@ -542,12 +671,18 @@ void EAPopulation::updateDeathProbabilities(void){
 
 	double sumoneOverFitness = sum(oneOverFitness);
 
+	cumulativeDeathProbabilities.set_size(getSize());
+
+	double probabilitySum = 0.0;
 	i=0;
 	for(auto it = std::begin(population); it != std::end(population); ++it) {
 
 
 		double deathProbability = oneOverFitness(i)/sumoneOverFitness;
 		it->setDeathProbabilityValue(deathProbability );
+
+		probabilitySum += deathProbability;
+		cumulativeDeathProbabilities(i) = probabilitySum;
 		i++;
 	}
 
@@ -565,47 +700,119 @@ void EAPopulation::updatePopulationProperties(void){
 }
 
 
-EAIndividual EAPopulation::pickUpARandomIndividualForReproduction(void) const{
+/* binary search in the cumulative probabilities, the probabilities must be updated after the last change of the population */
+unsigned int EAPopulation::findOrderByCumulativeProbability(const vec &cumulativeProbabilities) const{
 
+	unsigned int N = getSize();
 
-	double probabilitySum = 0.0;
-	double randomNumberBetweenOneAndZero = generateRandomDouble(0.0,1.0);
-	for(auto it = std::begin(population); it != std::end(population); ++it) {
+	assert(N > 0);
+	assert(cumulativeProbabilities.size() == N);
 
-		probabilitySum += it->getReproductionProbability();
+	double randomNumberBetweenOneAndZero = generateRandomDouble(0.0,1.0)*cumulativeProbabilities(N-1);
 
+	const double *begin = cumulativeProbabilities.memptr();
+	unsigned int order = std::upper_bound(begin, begin + N, randomNumberBetweenOneAndZero) - begin;
 
-		if (randomNumberBetweenOneAndZero < probabilitySum) {
+	if(order >= N) order = N-1;
 
-			return *it;
-			break;
-		}
-	}
+	return order;
+}
 
-	assert(false);
+
+EAIndividual EAPopulation::pickUpARandomIndividualForReproduction(void) const{
+
+	unsigned int order = findOrderByCumulativeProbability(cumulativeReproductionProbabilities);
+
+	return population[order];
 
 }
 
 
 unsigned int EAPopulation::pickUpAnIndividualThatWillDie(void) const{
 
-	unsigned int order = 0;
-	double probabilitySum = 0.0;
-	double randomNumberBetweenOneAndZero = generateRandomDouble(0.0,1.0);
-	for(auto it = std::begin(population); it != std::end(population); ++it) {
+	return findOrderByCumulativeProbability(cumulativeDeathProbabilities);
 
-		probabilitySum += it->getDeathProbability();
+}
 
+/** Picks howMany different individuals according to the death probabilities (sampling without replacement).
+ * If all individuals with a positive death probability are picked, the rest of them (except the best one)
+ * are picked with equal probabilities
+ * @param[in] howMany
+ * @return orders of the individuals in the population
+ *
+ */
+std::vector<unsigned int> EAPopulation::pickUpIndividualsThatWillDie(unsigned int howMany) const{
 
-		if (randomNumberBetweenOneAndZero < probabilitySum) {
+	unsigned int N = getSize();
 
-			break;
+	assert(howMany < N);
+
+	vec weights(N);
+	unsigned int numberOfCandidates = 0;
+
+	for(unsigned int i=0; i<N; i++){
+
+		weights(i) = population[i].getDeathProbability();
+		if(weights(i) > 0.0) numberOfCandidates++;
+	}
+
+	FenwickTree deathProbabilities;
+	deathProbabilities.initialize(weights);
+
+	std::vector<bool> isPicked(N, false);
+	std::vector<unsigned int> orders;
+	orders.reserve(howMany);
+
+	int orderOfTheBestIndividual = getIndividualOrderInPopulationById(idPopulationMinimum);
+
+	bool ifTreeIsRebuilt = false;
+
+	while(orders.size() < howMany){
+
+		if(numberOfCandidates == 0){
+
+			for(unsigned int i=0; i<N; i++){
+
+				if(!isPicked[i] && int(i) != orderOfTheBestIndividual){
+
+					deathProbabilities.addToWeight(i, 1.0 - weights(i));
+					weights(i) = 1.0;
+					numberOfCandidates++;
+				}
+			}
+
+			if(numberOfCandidates == 0) break;
 		}
 
-		order++;
+		double randomNumber = generateRandomDouble(0.0, deathProbabilities.getTotalWeight());
+		unsigned int order = deathProbabilities.findIndexOfCumulativeWeight(randomNumber);
+
+		/* may happen due to round-off in the cumulative sums: the tree is built again from the remaining weights,
+		 * if this does not help, one of the remaining candidates is picked with equal probability */
+		if(isPicked[order] || weights(order) <= 0.0){
+
+			if(!ifTreeIsRebuilt){
+
+				deathProbabilities.initialize(weights);
+				ifTreeIsRebuilt = true;
+				continue;
+			}
+
+			uvec remainingCandidates = find(weights > 0.0);
+			assert(remainingCandidates.size() > 0);
+			order = generateRandomInt(remainingCandidates);
+		}
+
+		orders.push_back(order);
+		isPicked[order] = true;
+		deathProbabilities.addToWeight(order, -weights(order));
+		weights(order) = 0.0;
+		numberOfCandidates--;
+		ifTreeIsRebuilt = false;
+
 	}
 
-	return order;
+	return orders;
 
 }
 
@@ -614,6 +821,7 @@ unsigned int EAPopulation::pickUpAnIndividualThatWillDie(void) const{
 EAOptimizer::EAOptimizer(){
 
 	setNumberOfThreads(1);
+	ifNumberOfThreadsIsSet = false;
 
 }
 
@@ -701,6 +909,21 @@ void EAOptimizer::callObjectiveFunction(EAIndividual &individual){
 
 
 
+/* returns a unique id for a new individual, safe to call from parallel regions */
+unsigned int EAOptimizer::generateNewId(void){
+
+	unsigned int id;
+
+#pragma omp atomic capture
+	id = idOfTheNextIndividual++;
+
+#pragma omp atomic
+	totalNumberOfGeneratedIndividuals++;
+
+	return id;
+}
+
+
 EAIndividual  EAOptimizer::generateRandomIndividual(void){
 
 
@@ -712,8 +935,7 @@ EAIndividual  EAOptimizer::generateRandomIndividual(void){
 	vec randomGenes = parameterBounds.generateVectorWithinBounds();
 //	output.printMessage("x", randomGenes);
 	newIndividual.initializeGenes(randomGenes);
-	newIndividual.setId(totalNumberOfGeneratedIndividuals);
-	totalNumberOfGeneratedIndividuals++;
+	newIndividual.setId(generateNewId());
 
 	callObjectiveFunction(newIndividual);
 //	output.printMessage("f(x) = ", newIndividual.getObjectiveFunctionValue());
@@ -732,33 +954,22 @@ void EAOptimizer::initializePopulation(void){
 
 	output.printMessage("Size of initial population = ",sizeOfInitialPopulation);
 
-#pragma omp parallel
-	{
+	/* genes are generated serially, only the objective function evaluations run in parallel */
 
-		std::vector<EAIndividual> slavePopulation;
+	std::vector<EAIndividual> initialPopulation;
+	initialPopulation.reserve(sizeOfInitialPopulation);
 
-#pragma omp for nowait
-		for (unsigned int i = 0; i < sizeOfInitialPopulation; ++i)
-		{
+	for (unsigned int i = 0; i < sizeOfInitialPopulation; ++i){
 
-			if(i%100 == 0) {
-
-				output.printMessage("Iteration = ",i);
-			}
-			EAIndividual generatedIndividual = generateRandomIndividual();
-			slavePopulation.push_back(generatedIndividual);
-		}
-
-
-#pragma omp critical
-		{
-			/* merge populations from each thread */
-			population.addAGroupOfIndividuals(slavePopulation);
-
-
-		}
+		EAIndividual newIndividual(dimension);
+		newIndividual.initializeGenes(parameterBounds.generateVectorWithinBounds());
+		newIndividual.setId(generateNewId());
+		initialPopulation.push_back(newIndividual);
 	}
 
+	callObjectiveFunctionForAGroup(initialPopulation);
+
+	population.addAGroupOfIndividuals(initialPopulation);
 
 	population.updatePopulationProperties();
 
@@ -910,7 +1121,7 @@ EAIndividual EAOptimizer::crossOver(std::pair<EAIndividual, EAIndividual> parent
 
 	EAIndividual child(dimension);
 	child.setGenes(newGenes);
-	child.setId(totalNumberOfGeneratedIndividuals);
+	child.setId(generateNewId());
 
 
 	return child;
@@ -924,19 +1135,43 @@ EAIndividual  EAOptimizer::generateIndividualByReproduction(std::pair<EAIndividu
 
 	EAIndividual child =  crossOver(parents);
 	applyBoundsIfNecessary(child);
-	totalNumberOfGeneratedIndividuals++;
 
 	return child;
 
 }
 
+/* each individual is evaluated exactly once, the evaluation cost may vary a lot between individuals,
+ * therefore the work is distributed dynamically. Objective functions that are not reentrant (derived classes that do not
+ * set ifObjectiveFunctionIsReentrant) are always evaluated serially, reentrant ones use all processors unless the
+ * number of threads is set */
+unsigned int EAOptimizer::getNumberOfThreadsForEvaluation(void) const{
+
+	if(!ifObjectiveFunctionIsReentrant) return 1;
+
+	/* called within a parallel region (e.g. several optimizers run in parallel), nested regions get a single thread */
+	if(omp_get_active_level() >= omp_get_max_active_levels()) return 1;
+
+	if(ifNumberOfThreadsIsSet) return numberOfThreads;
+
+	return omp_get_num_procs();
+}
+
+/* derived classes with a state (e.g. a model that is modified by each evaluation) create a copy of it for each thread */
+void EAOptimizer::prepareObjectiveFunctionForThreads(unsigned int numberOfThreads){
+
+}
+
 void EAOptimizer::callObjectiveFunctionForAGroup(
 		std::vector<EAIndividual> &children) {
-#pragma omp parallel
-	{
-		for (auto it = std::begin(children); it != std::end(children); ++it) {
-			callObjectiveFunction(*it);
-		}
+
+	unsigned int numberOfChildren = children.size();
+	unsigned int numberOfThreadsForEvaluation = getNumberOfThreadsForEvaluation();
+
+	prepareObjectiveFunctionForThreads(numberOfThreadsForEvaluation);
+
+#pragma omp parallel for schedule(dynamic) num_threads(numberOfThreadsForEvaluation) if(numberOfThreadsForEvaluation > 1)
+	for (unsigned int i = 0; i < numberOfChildren; ++i) {
+		callObjectiveFunction(children[i]);
 	}
 
 }
@@ -964,17 +1199,11 @@ void EAOptimizer::addNewIndividualsToPopulation(void) {
 }
 
 
+/* all individuals that will die are picked at once, the population properties are updated afterwards in generateANewGeneration */
 void EAOptimizer::removeIndividualsFromPopulation(void) {
 
-
-	for(unsigned int i=0; i<numberOfDeathsInAGeneration; i++){
-
-		unsigned int order = population.pickUpAnIndividualThatWillDie();
-		population.removeIndividual(order);
-		population.updatePopulationProperties();
-
-	}
-
+	std::vector<unsigned int> ordersOfIndividualsToRemove = population.pickUpIndividualsThatWillDie(numberOfDeathsInAGeneration);
+	population.removeIndividuals(ordersOfIndividualsToRemove);
 
 }
 
@@ -1026,6 +1255,7 @@ void EAOptimizer::setWarmStartOff(void){
 void EAOptimizer::optimize(void){
 
 	totalNumberOfGeneratedIndividuals = 0;
+	idOfTheNextIndividual = 0;
 	output.printMessage("EA Optimizer: start...");
 	checkIfSettingsAreOk();
 
@@ -1062,6 +1292,9 @@ void EAOptimizer::optimize(void){
 
 	output.printMessage("EA Optimization has been terminated...\n");
 
+	/* the copies of the objective function for the other threads are not needed any more */
+	prepareObjectiveFunctionForThreads(1);
+
 	printSolution();
 
 	double mutationCrossOverRatio = double(totalNumberOfMutations)/double(totalNumberOfCrossOvers);
@@ -1104,6 +1337,9 @@ void EAOptimizer::readWarmRestartFile(void){
 	population.readFromFile(filenameWarmStart);
 	ifPopulationIsInitialized = true;
 
+	/* the ids of the new individuals must not collide with the ids given to the individuals in the file */
+	idOfTheNextIndividual = std::max(idOfTheNextIndividual, population.getMaximumId() + 1);
+
 }
 
 
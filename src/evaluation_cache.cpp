@@ -0,0 +1,219 @@
+/*
+ * RoDeO, a Robust Design Optimization Package
+ *
+ * Copyright (C) 2015-2021 Chair for Scientific Computing (SciComp), TU Kaiserslautern
+ * Homepage: http://www.scicomp.uni-kl.de
+ * Contact:  Prof. Nicolas R. Gauger (nicolas.gauger@scicomp.uni-kl.de) or Dr. Emre Özkaya (emre.oezkaya@scicomp.uni-kl.de)
+ *
+ * Lead developer: Emre Özkaya (SciComp, TU Kaiserslautern)
+ *
+ * This file is part of RoDeO
+ *
+ * RoDeO is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * RoDeO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details.
+ * You should have received a copy of the GNU
+ * General Public License along with CoDiPack.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors: Emre Özkaya, (SciComp, TU Kaiserslautern)
+ *
+ *
+ *
+ */
+
+#include "evaluation_cache.hpp"
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <iostream>
+#include <unistd.h>
+
+static const char cacheFileHeader[] = "RODEOEC1";
+static const size_t cacheFileHeaderLength = 8;
+
+EvaluationCache::EvaluationCache(std::string name){
+
+	assert(!name.empty());
+
+	filename = name;
+
+	if(!readFile()){
+
+		std::cout<<"WARNING: "<<filename<<" is not an evaluation cache file, the cache is not used!\n";
+		return;
+	}
+
+	fileAppend = fopen(filename.c_str(), "ab");
+
+	if(fileAppend == NULL){
+
+		std::cout<<"WARNING: The evaluation cache file "<<filename<<" cannot be opened, the entries are not saved!\n";
+		return;
+	}
+
+	if(ftell(fileAppend) == 0){
+
+		fwrite(cacheFileHeader, 1, cacheFileHeaderLength, fileAppend);
+		fflush(fileAppend);
+	}
+
+}
+
+EvaluationCache::~EvaluationCache(){
+
+	if(fileAppend != NULL) fclose(fileAppend);
+}
+
+/* reads the entries of an existing file, returns false if the file exists but is not a cache file */
+
+bool EvaluationCache::readFile(void){
+
+	FILE *fileRead = fopen(filename.c_str(), "rb");
+
+	if(fileRead == NULL) return true;
+
+	char header[cacheFileHeaderLength];
+
+	size_t headerSize = fread(header, 1, cacheFileHeaderLength, fileRead);
+
+	if(headerSize == 0){
+
+		fclose(fileRead);
+		return true;
+	}
+
+	if(headerSize != cacheFileHeaderLength || memcmp(header, cacheFileHeader, cacheFileHeaderLength) != 0){
+
+		fclose(fileRead);
+		return false;
+	}
+
+	long sizeOfCompleteRecords = ftell(fileRead);
+
+	while(1){
+
+		uint32_t keyLength, n;
+
+		if(fread(&keyLength, sizeof(uint32_t), 1, fileRead) != 1) break;
+
+		std::string key(keyLength, '\0');
+		if(keyLength > 0 && fread(&key[0], 1, keyLength, fileRead) != keyLength) break;
+
+		if(fread(&n, sizeof(uint32_t), 1, fileRead) != 1) break;
+
+		std::vector<double> values(n);
+		if(n > 0 && fread(values.data(), sizeof(double), n, fileRead) != n) break;
+
+		entries[key] = values;
+		numberOfEntriesReadFromFile++;
+
+		sizeOfCompleteRecords = ftell(fileRead);
+	}
+
+	fseek(fileRead, 0, SEEK_END);
+	long fileSize = ftell(fileRead);
+
+	fclose(fileRead);
+
+	/* an incomplete record is removed, so that new records are appended after the last complete one */
+
+	if(fileSize > sizeOfCompleteRecords){
+
+		if(truncate(filename.c_str(), sizeOfCompleteRecords) != 0){
+			std::cout<<"WARNING: The incomplete record at the end of "<<filename<<" cannot be removed!\n";
+		}
+	}
+
+	return true;
+}
+
+/** Builds the key of a cache entry.
+ *
+ * @param[in] name: name of the objective function or the constraint
+ * @param[in] mode: evaluation mode
+ * @param[in] values: design vector (followed by the tangent direction in the tangent mode)
+ */
+
+std::string EvaluationCache::generateKey(const std::string &name, const std::string &mode, const std::vector<double> &values){
+
+	std::string key = name;
+	key.push_back('\0');
+	key += mode;
+	key.push_back('\0');
+
+	for(auto it = values.begin(); it != values.end(); it++){
+
+		int exponent = 0;
+		double mantissa = frexp(*it, &exponent);
+
+		int64_t quantizedMantissa = llround(ldexp(mantissa, 40));
+		int32_t exponent32 = exponent;
+
+		if(quantizedMantissa == 0) exponent32 = 0;
+
+		key.append(reinterpret_cast<const char *>(&quantizedMantissa), sizeof(int64_t));
+		key.append(reinterpret_cast<const char *>(&exponent32), sizeof(int32_t));
+	}
+
+	return key;
+}
+
+bool EvaluationCache::find(const std::string &key, std::vector<double> &values) const{
+
+	std::lock_guard<std::mutex> lock(cacheMutex);
+
+	auto it = entries.find(key);
+
+	if(it == entries.end()) return false;
+
+	values = it->second;
+	return true;
+}
+
+void EvaluationCache::add(const std::string &key, const std::vector<double> &values){
+
+	std::lock_guard<std::mutex> lock(cacheMutex);
+
+	if(entries.find(key) != entries.end()) return;
+
+	entries[key] = values;
+
+	if(fileAppend != NULL){
+
+		uint32_t keyLength = key.size();
+		uint32_t n = values.size();
+
+		fwrite(&keyLength, sizeof(uint32_t), 1, fileAppend);
+		fwrite(key.data(), 1, keyLength, fileAppend);
+		fwrite(&n, sizeof(uint32_t), 1, fileAppend);
+		if(n > 0) fwrite(values.data(), sizeof(double), n, fileAppend);
+
+		fflush(fileAppend);
+	}
+
+}
+
+unsigned int EvaluationCache::getNumberOfEntries(void) const{
+
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	return entries.size();
+}
+
+unsigned int EvaluationCache::getNumberOfEntriesReadFromFile(void) const{
+
+	return numberOfEntriesReadFromFile;
+}
+
+std::string EvaluationCache::getFileName(void) const{
+
+	return filename;
+}
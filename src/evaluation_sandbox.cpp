@@ -0,0 +1,161 @@
+/*
+ * RoDeO, a Robust Design Optimization Package
+ *
+ * Copyright (C) 2015-2021 Chair for Scientific Computing (SciComp), TU Kaiserslautern
+ * Homepage: http://www.scicomp.uni-kl.de
+ * Contact:  Prof. Nicolas R. Gauger (nicolas.gauger@scicomp.uni-kl.de) or Dr. Emre Özkaya (emre.oezkaya@scicomp.uni-kl.de)
+ *
+ * Lead developer: Emre Özkaya (SciComp, TU Kaiserslautern)
+ *
+ * This file is part of RoDeO
+ *
+ * RoDeO is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * RoDeO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details.
+ * You should have received a copy of the GNU
+ * General Public License along with CoDiPack.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors: Emre Özkaya, (SciComp, TU Kaiserslautern)
+ *
+ *
+ *
+ */
+
+#include "evaluation_sandbox.hpp"
+#include "auxiliary_functions.hpp"
+#include <cassert>
+#include <cerrno>
+#include <cstdlib>
+#include <cstdio>
+#include <sys/stat.h>
+
+
+EvaluationSandbox::EvaluationSandbox(){
+
+	jobCounter = 0;
+}
+
+void EvaluationSandbox::setRootDirectory(std::string directory){
+
+	assert(isNotEmpty(directory));
+	rootDirectory = directory;
+}
+
+void EvaluationSandbox::setTemplateDirectory(std::string directory){
+
+	if(isNotEmpty(directory) && !directory_exist(directory)){
+		abortWithErrorMessage("The template directory of the sandbox does not exist: " + directory);
+	}
+
+	templateDirectory = directory;
+}
+
+void EvaluationSandbox::setArchiveDirectory(std::string directory){
+
+	archiveDirectory = directory;
+}
+
+std::string EvaluationSandbox::getRootDirectory(void) const{
+
+	return rootDirectory;
+}
+
+bool EvaluationSandbox::isArchiveOn(void) const{
+
+	return isNotEmpty(archiveDirectory);
+}
+
+/** Creates a new job directory "rootDirectory/jobName_k" and fills it with the content of the template directory,
+ * can be called concurrently. Directories left over from previous runs (or already in the archive) are not reused.
+ *
+ * @param[in] jobName: prefix of the job directory, e.g. the name of the objective function
+ * @return path of the job directory
+ */
+
+std::string EvaluationSandbox::createJobDirectory(std::string jobName){
+
+	assert(isNotEmpty(jobName));
+
+	if(!createDirectory(rootDirectory)){
+		abortWithErrorMessage("Cannot create the sandbox directory: " + rootDirectory);
+	}
+
+	while(1){
+
+		unsigned int jobID = jobCounter++;
+
+		std::string name = jobName + "_" + std::to_string(jobID);
+		std::string directory = rootDirectory + "/" + name;
+
+		if(isArchiveOn() && directory_exist(archiveDirectory + "/" + name)) continue;
+
+		/* mkdir fails if the directory exists, therefore every job gets a directory that is not used by another job */
+
+		if(mkdir(directory.c_str(), 0755) == 0){
+
+			copyTemplateToDirectory(directory);
+			return directory;
+		}
+
+		if(errno != EEXIST){
+			abortWithErrorMessage("Cannot create the job directory: " + directory);
+		}
+	}
+
+}
+
+void EvaluationSandbox::copyTemplateToDirectory(std::string directory) const{
+
+	assert(directory_exist(directory));
+
+	if(isNotEmpty(templateDirectory)){
+
+		std::string command = "cp -r " + quoteForShell(templateDirectory + "/.") + " " + quoteForShell(directory);
+
+		if(system(command.c_str()) != 0){
+			abortWithErrorMessage("Cannot copy the template directory to: " + directory);
+		}
+	}
+
+}
+
+/* removes the job directory or moves it to the archive directory */
+
+void EvaluationSandbox::finalizeJobDirectory(std::string directory) const{
+
+	assert(isNotEmpty(directory));
+
+	if(isArchiveOn()){
+
+		if(!createDirectory(archiveDirectory)){
+			abortWithErrorMessage("Cannot create the archive directory: " + archiveDirectory);
+		}
+
+		std::string name = directory.substr(directory.find_last_of('/') + 1);
+		std::string archivedDirectory = archiveDirectory + "/" + name;
+
+		/* rename does not work across file systems, then the directory is moved by mv */
+
+		if(rename(directory.c_str(), archivedDirectory.c_str()) != 0){
+
+			std::string command = "mv " + quoteForShell(directory) + " " + quoteForShell(archivedDirectory);
+
+			if(errno != EXDEV || system(command.c_str()) != 0){
+				abortWithErrorMessage("Cannot move the job directory to the archive: " + directory);
+			}
+		}
+	}
+	else{
+
+		removeDirectory(directory);
+	}
+
+}
@@ -165,6 +165,7 @@ void GeneralPurposeOptimizer::setObjectiveFunction(GeneralPurposeObjectiveFuncti
 	assert(functionToSet != NULL);
 	calculateObjectiveFunction = functionToSet;
 	ifObjectiveFunctionIsSet = true;
+	ifObjectiveFunctionIsReentrant = true;
 
 }
 
@@ -172,6 +173,7 @@ void GeneralPurposeOptimizer::setObjectiveFunction(GeneralPurposeObjectiveFuncti
 void GeneralPurposeOptimizer::setNumberOfThreads(unsigned int nThreads){
 
 	numberOfThreads = nThreads;
+	ifNumberOfThreadsIsSet = true;
 	omp_set_num_threads(numberOfThreads);
 
 
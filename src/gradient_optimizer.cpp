@@ -131,6 +131,14 @@ void GradientOptimizer::checkIfOptimizationSettingsAreOk(void) const{
 
 }
 
+/* search directions are computed with a BFGS approximation of the inverse Hessian instead of steepest descent */
+
+void GradientOptimizer::setBFGSUpdateOn(void){
+
+	ifBFGSUpdateIsOn = true;
+
+}
+
 void GradientOptimizer::setEpsilonForFiniteDifference(double value) {
 
 	assert(value>0.0);
@@ -261,24 +269,96 @@ void GradientOptimizer::performGoldenSectionSearch(void){
 
 
 
+}
+
+vec GradientOptimizer::projectToBounds(vec x) const{
+
+	vec lb = parameterBounds.getLowerBounds();
+	vec ub = parameterBounds.getUpperBounds();
+
+	for(unsigned int i=0; i<dimension; i++){
+
+		if(x(i) < lb(i)) x(i) = lb(i);
+		if(x(i) > ub(i)) x(i) = ub(i);
+	}
+
+	return x;
+
+}
+
+/* norm of the projected gradient step, it is zero at a stationary point of the bounded problem */
+
+double GradientOptimizer::calculateProjectedGradientNorm(const designPoint &input) const{
+
+	vec step = projectToBounds(input.x - input.gradient) - input.x;
+
+	return norm(step);
+
+}
+
+vec GradientOptimizer::calculateSearchDirection(void){
+
+	if(!ifBFGSUpdateIsOn){
+
+		return -currentIterate.gradient;
+	}
+
+	if(inverseHessian.n_rows != dimension){
+
+		inverseHessian = eye<mat>(dimension,dimension);
+	}
+
+	vec direction = -inverseHessian*currentIterate.gradient;
+
+	/* restart with steepest descent if the direction is not a descent direction */
+	if(dot(direction,currentIterate.gradient) >= 0.0){
+
+		inverseHessian = eye<mat>(dimension,dimension);
+		direction = -currentIterate.gradient;
+	}
+
+	return direction;
+
+}
+
+void GradientOptimizer::updateInverseHessian(const designPoint &previousIterate){
+
+	vec s = currentIterate.x - previousIterate.x;
+	vec y = currentIterate.gradient - previousIterate.gradient;
+
+	double sTy = dot(s,y);
+
+	/* skip the update if the curvature condition is not satisfied */
+	if(sTy <= EPSILON) return;
+
+	double rho = 1.0/sTy;
+	mat I = eye<mat>(dimension,dimension);
+
+	inverseHessian = (I - rho*s*trans(y))*inverseHessian*(I - rho*y*trans(s)) + rho*s*trans(s);
+
 }
 
 void GradientOptimizer::performBacktrackingLineSearch(void){
 
 	assert(maximumStepSize > 0);
 
-	designPoint currentIterateSave = currentIterate;
+	designPoint previousIterate = currentIterate;
+
+	vec direction = calculateSearchDirection();
 
 	double stepSize = maximumStepSize;
-	while(true){
+	bool ifStepIsAccepted = false;
+
+	for(unsigned int iteration=0; iteration<maximumNumberOfIterationsInLineSearch; iteration++){
 
 
-		nextIterate.x = currentIterate.x - stepSize* currentIterate.gradient;
+		nextIterate.x = projectToBounds(currentIterate.x + stepSize*direction);
 
 		evaluateObjectiveFunction(nextIterate);
 
 		if(nextIterate.objectiveFunctionValue < currentIterate.objectiveFunctionValue){
 
+			ifStepIsAccepted = true;
 			break;
 		}
 		else{
@@ -288,14 +368,36 @@ void GradientOptimizer::performBacktrackingLineSearch(void){
 			output.printMessage("Stepsize = " , stepSize);
 		}
 
+		if(numberOfMaximumFunctionEvaluations > 0 && numberOfFunctionEvaluations >= numberOfMaximumFunctionEvaluations){
 
+			break;
+		}
+
+	}
+
+	if(!ifStepIsAccepted){
+
+		if(ifBFGSUpdateIsOn && !inverseHessian.is_empty()){
+
+			/* try again with steepest descent in the next iteration */
+			inverseHessian.reset();
+		}
+		else{
 
+			ifLineSearchHasFailed = true;
+		}
+		return;
 	}
 
 
 	currentIterate = nextIterate;
 	evaluateGradientFunction(currentIterate);
 
+	if(ifBFGSUpdateIsOn){
+
+		updateInverseHessian(previousIterate);
+	}
+
 	output.printMessage("f1 = ",currentIterate.objectiveFunctionValue);
 	optimalObjectiveFunctionValue = currentIterate.objectiveFunctionValue;
 
@@ -327,8 +429,13 @@ void GradientOptimizer::optimize(void){
 
 	checkIfOptimizationSettingsAreOk();
 
+	currentIterate.x = projectToBounds(currentIterate.x);
+	inverseHessian.reset();
+	ifLineSearchHasFailed = false;
+
 	evaluateObjectiveFunction(currentIterate);
 	evaluateGradientFunction(currentIterate);
+	optimalObjectiveFunctionValue = currentIterate.objectiveFunctionValue;
 
 	output.printMessage("Initial gradient", currentIterate.gradient);
 
@@ -336,13 +443,18 @@ void GradientOptimizer::optimize(void){
 	while(true){
 
 
-		if(currentIterate.L2NormGradient < tolerance){
+		if(calculateProjectedGradientNorm(currentIterate) < tolerance){
 
 			break;
 		}
 
 		performLineSearch();
 
+		if(ifLineSearchHasFailed){
+
+			break;
+		}
+
 
 
 
@@ -366,5 +478,15 @@ double GradientOptimizer::getOptimalObjectiveFunctionValue(void) const{
 	return optimalObjectiveFunctionValue;
 }
 
+vec GradientOptimizer::getOptimalDesignVector(void) const{
+
+	return currentIterate.x;
+}
+
+unsigned int GradientOptimizer::getNumberOfFunctionEvaluations(void) const{
+
+	return numberOfFunctionEvaluations;
+}
+
 
 
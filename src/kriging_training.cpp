@@ -34,11 +34,15 @@
 #include<fstream>
 #include<string>
 #include<cassert>
+#include<algorithm>
+#include<vector>
+#include<omp.h>
 
 #include "kriging_training.hpp"
 #include "linear_regression.hpp"
 #include "auxiliary_functions.hpp"
 #include "random_functions.hpp"
+#include "lhs.hpp"
 #include "Rodeo_macros.hpp"
 #include "Rodeo_globals.hpp"
 
@@ -115,9 +119,10 @@ void KrigingModel::initializeSurrogateModel(void){
 			linearModel.setGradientsOn();
 		}
 
-		linearModel.readData();
-		linearModel.setBoxConstraints(data.getBoxConstraints());
-		linearModel.normalizeData();
+		/* the linear model shares the data, it is trained with the original outputs, y of the Kriging model
+		 * is replaced by the residual below */
+		data.assignSampleOutputVector();
+		linearModel.setData(data);
 		linearModel.initializeSurrogateModel();
 		linearModel.train();
 
@@ -249,6 +254,15 @@ void KrigingModel::setEpsilon(double value){
 
 }
 
+/* upper limit (in MB) for the pairwise distances precomputed for the training */
+
+void KrigingModel::setMaximumMemoryForDistanceCache(double value){
+
+	assert(value>=0);
+	correlationFunction.setMaximumMemoryForDistanceCache(value);
+
+}
+
 void KrigingModel::setLinearRegressionOn(void){
 
 	ifUsesLinearRegression  = true;
@@ -275,16 +289,16 @@ void KrigingModel::addNewSampleToData(rowvec newsample){
 
 	/* avoid points that are too close to each other */
 
-	mat rawData = data.getRawData();
-
-	bool flagTooClose= checkifTooCLose(newsample, rawData);
+	bool flagTooClose= checkifTooCLose(newsample, mat(data.getRawData()));
 
 
 	if(!flagTooClose){
 
-		appendRowVectorToCSVData(newsample, filenameDataInput);
+		/* the file is written in the background, the model is updated with the data in memory */
 
-		updateModelWithNewData();
+		SurrogateModelData::appendSampleToFileAsynchronously(newsample, filenameDataInput);
+
+		updateModelWithNewSample(newsample);
 
 	}
 	else{
@@ -333,10 +347,12 @@ void KrigingModel::printSurrogateModel(void) const{
 void KrigingModel::resetDataObjects(void){
 
 	R_inv_I.reset();
+	L_inv_I.reset();
 	R_inv_ys_min_beta.reset();
 	vectorOfOnes.reset();
 	beta0 = 0.0;
 	sigmaSquared = 0.0;
+	dotITRinvI = 0.0;
 
 }
 
@@ -464,9 +480,6 @@ void KrigingModel::updateAuxilliaryFields(void){
 
 	assert(ifDataIsRead);
 
-	unsigned int N = data.getNumberOfSamples();
-
-
 	correlationFunction.computeCorrelationMatrix();
 	mat R = correlationFunction.getCorrelationMatrix();
 
@@ -477,31 +490,56 @@ void KrigingModel::updateAuxilliaryFields(void){
 
 	linearSystemCorrelationMatrix.factorize();
 
+	updateBeta0AndSigmaSquared();
+
+
+#if 0
+
+	checkAuxilliaryFields();
+
+#endif
+
+}
+
+/* computes beta0, sigma^2 and the auxiliary vectors using the current factorization of R */
+
+void KrigingModel::updateBeta0AndSigmaSquared(void){
+
+	unsigned int N = data.getNumberOfSamples() + outputValuesPendingSamples.size();
 
 	R_inv_ys = zeros<vec>(N);
 	R_inv_I = zeros<vec>(N);
+	L_inv_I = zeros<vec>(N);
 	R_inv_ys_min_beta = zeros<vec>(N);
+	vectorOfOnes = ones<vec>(N);
 	beta0 = 0.0;
 	sigmaSquared = 0.0;
+	dotITRinvI = 0.0;
 
 	if(linearSystemCorrelationMatrix.isFactorizationDone()){
 
-		/* solve R x = ys */
-		vec ys = data.getOutputVector();
+		vec ys = join_cols(data.getOutputVector(), outputValuesPendingSamples);
 
-		R_inv_ys = linearSystemCorrelationMatrix.solveLinearSystem(ys);
+		/* solve R x = ys and R x = I in a single pass, L^-1 I is kept for the variance computations */
 
-		/* solve R x = I */
+		mat rhs = join_rows(ys, vectorOfOnes);
+		mat L_inv_rhs = linearSystemCorrelationMatrix.forwardSubstitution(rhs);
+		mat solution  = linearSystemCorrelationMatrix.backwardSubstitution(L_inv_rhs);
 
-		R_inv_I = linearSystemCorrelationMatrix.solveLinearSystem(vectorOfOnes);
+		R_inv_ys = solution.col(0);
+		R_inv_I  = solution.col(1);
+		L_inv_I  = L_inv_rhs.col(1);
 
-		beta0 = (1.0/dot(vectorOfOnes,R_inv_I)) * (dot(vectorOfOnes,R_inv_ys));
+		/* I^T R^-1 I = || L^-1 I ||^2 */
+		dotITRinvI = dot(L_inv_I,L_inv_I);
+
+		beta0 = (1.0/dotITRinvI) * (dot(vectorOfOnes,R_inv_ys));
 
 		vec ys_min_betaI = ys - beta0*vectorOfOnes;
 
-		/* solve R x = ys-beta0*I */
+		/* R^-1 (ys-beta0*I) = R^-1 ys - beta0 * R^-1 I, no additional solve is required */
 
-		R_inv_ys_min_beta = linearSystemCorrelationMatrix.solveLinearSystem( ys_min_betaI);
+		R_inv_ys_min_beta = R_inv_ys - beta0*R_inv_I;
 
 		sigmaSquared = (1.0 / N) * dot(ys_min_betaI, R_inv_ys_min_beta);
 
@@ -510,17 +548,11 @@ void KrigingModel::updateAuxilliaryFields(void){
 
 	yMin = data.getMinimumOutputVector();
 
-
-#if 0
-
-	checkAuxilliaryFields();
-
-#endif
-
 }
 
 void KrigingModel::updateModelWithNewData(void){
 
+	outputValuesPendingSamples.reset();
 	resetDataObjects();
 	readData();
 	normalizeData();
@@ -528,6 +560,160 @@ void KrigingModel::updateModelWithNewData(void){
 
 }
 
+/** Updates the model after a single sample is appended to the data in memory, the training data file is not read again.
+ * Since the hyperparameters and the box constraints do not change, the Cholesky factor of R is extended by one row
+ * and column in O(N^2) instead of assembling and factorizing the correlation matrix from scratch
+ * @param[in] newsample: raw sample (design vector, function value and gradient if the data has gradients)
+ *
+ */
+
+void KrigingModel::updateModelWithNewSample(const rowvec &newsample){
+
+	if(!ifDataIsRead || !ifNormalized){
+
+		/* the sample must be in the training data file for the full update */
+		updateModelWithNewData();
+		return;
+	}
+
+	removePendingSamples();
+
+	data.appendSample(newsample);
+
+	updateModelWithTheLastSample();
+
+}
+
+/** Updates the model with the data of a composite model, so that both models keep sharing the same sample matrices.
+ * If the data has exactly one new sample at the end, the Cholesky factor is extended as above, otherwise the model
+ * is initialized again with the new data.
+ * @param[in] newData: normalized data
+ *
+ */
+
+void KrigingModel::updateModelWithSharedData(const SurrogateModelData &newData){
+
+	assert(newData.isDataNormalized());
+
+	bool ifOneNewSample = ifDataIsRead && newData.getNumberOfSamples() == data.getNumberOfSamples() + 1;
+
+	removePendingSamples();
+
+	setData(newData);
+
+	if(ifOneNewSample){
+
+		updateModelWithTheLastSample();
+	}
+	else{
+
+		resetDataObjects();
+		initializeSurrogateModel();
+	}
+
+}
+
+/* extends the correlation matrix and its Cholesky factor with the last sample of the data, the model is initialized
+ * again from the data in memory if the border update is not possible */
+
+void KrigingModel::updateModelWithTheLastSample(void){
+
+	if(!ifInitialized || ifUsesLinearRegression || !linearSystemCorrelationMatrix.isFactorizationDone()){
+
+		/* full update, e.g. the linear model must be retrained with the new data */
+		resetDataObjects();
+		initializeSurrogateModel();
+		return;
+	}
+
+	unsigned int N = data.getNumberOfSamples();
+
+	rowvec xNew = data.getRowX(N-1);
+
+	vec newColumn = correlationFunction.addNewSampleToInputMatrix(xNew);
+
+	linearSystemCorrelationMatrix.addRowAndColumn(newColumn);
+
+	if(linearSystemCorrelationMatrix.isFactorizationDone()){
+
+		updateBeta0AndSigmaSquared();
+	}
+	else{
+
+		output.printMessage("Border update of the Cholesky factor has failed, refactorizing the correlation matrix...");
+		updateAuxilliaryFields();
+	}
+
+}
+
+/** Adds a design that is still being evaluated to the model with a fictitious output value (Kriging believer
+ * if the value is the prediction of the model, constant liar if it is a fixed value). The hyperparameters are not changed,
+ * the Cholesky factor of R is extended as in updateModelWithNewSample. Nothing is written to the training data file.
+ *
+ * @param[in] xp: normalized design vector
+ * @param[in] fictitiousValue: output value assumed for xp
+ */
+
+void KrigingModel::addPendingSample(rowvec xp, double fictitiousValue){
+
+	assert(ifInitialized);
+	assert(xp.size() == data.getDimension());
+	assert(linearSystemCorrelationMatrix.isFactorizationDone());
+
+	if(outputValuesPendingSamples.empty()){
+
+		correlationFunctionWithoutPendingSamples = correlationFunction;
+		linearSystemWithoutPendingSamples = linearSystemCorrelationMatrix;
+	}
+
+	/* the Kriging part models the residual of the linear model */
+	if(ifUsesLinearRegression){
+
+		fictitiousValue -= linearModel.interpolate(xp);
+	}
+
+	vec newColumn = correlationFunction.addNewSampleToInputMatrix(xp);
+
+	linearSystemCorrelationMatrix.addRowAndColumn(newColumn);
+
+	outputValuesPendingSamples.resize(outputValuesPendingSamples.size()+1);
+	outputValuesPendingSamples(outputValuesPendingSamples.size()-1) = fictitiousValue;
+
+	if(linearSystemCorrelationMatrix.isFactorizationDone()){
+
+		updateBeta0AndSigmaSquared();
+	}
+	else{
+
+		output.printMessage("Border update of the Cholesky factor has failed, refactorizing the correlation matrix...");
+		updateAuxilliaryFields();
+	}
+
+}
+
+/* restores the model as it was before the first call of addPendingSample */
+
+void KrigingModel::removePendingSamples(void){
+
+	if(outputValuesPendingSamples.empty()) return;
+
+	outputValuesPendingSamples.reset();
+
+	correlationFunction = correlationFunctionWithoutPendingSamples;
+	linearSystemCorrelationMatrix = linearSystemWithoutPendingSamples;
+
+	correlationFunctionWithoutPendingSamples = ExponentialCorrelationFunction();
+	linearSystemWithoutPendingSamples = CholeskySystem();
+
+	updateBeta0AndSigmaSquared();
+
+}
+
+unsigned int KrigingModel::getNumberOfPendingSamples(void) const{
+
+	return outputValuesPendingSamples.size();
+}
+
 double KrigingModel::interpolate(rowvec xp ) const{
 
 
@@ -599,21 +785,32 @@ double KrigingModel::interpolate(rowvec xp ) const{
 //
 //}
 
+/** Computes the estimate and the variance with a single correlation vector r and a single forward substitution:
+ * r^T R^-1 r = ||L^-1 r||^2 and r^T R^-1 I = (L^-1 r)^T (L^-1 I), where L^-1 I is computed in updateAuxilliaryFields
+ *
+ */
+
 void KrigingModel::interpolateWithVariance(rowvec xp,double *ftildeOutput,double *sSqrOutput) const{
 
 	assert(ifInitialized);
-	unsigned int N = data.getNumberOfSamples();
-	*ftildeOutput =  interpolate(xp);
-	vec R_inv_r(N);
+
 	vec r = correlationFunction.computeCorrelationVector(xp);
 
-	/* solve the linear system R x = r by Cholesky matrices U and L*/
+	double estimateLinearRegression = 0.0;
 
-	R_inv_r = linearSystemCorrelationMatrix.solveLinearSystem(r);
+	if(ifUsesLinearRegression ){
 
-	double dotRTRinvR = dot(r,R_inv_r);
-	double dotRTRinvI = dot(r,R_inv_I);
-	double dotITRinvI = dot(vectorOfOnes,R_inv_I);
+		estimateLinearRegression = linearModel.interpolate(xp);
+	}
+
+	*ftildeOutput = estimateLinearRegression + beta0 + dot(r,R_inv_ys_min_beta);
+
+	/* solve L x = r */
+
+	vec L_inv_r = linearSystemCorrelationMatrix.forwardSubstitution(r);
+
+	double dotRTRinvR = dot(L_inv_r,L_inv_r);
+	double dotRTRinvI = dot(L_inv_r,L_inv_I);
 
 	double term1 = pow( (dotRTRinvI - 1.0 ),2.0)/dotITRinvI;
 
@@ -635,6 +832,136 @@ void KrigingModel::interpolateWithVariance(rowvec xp,double *ftildeOutput,double
 
 }
 
+/** Computes the estimate and the variance together with their analytic gradients with respect to xp,
+ * d(ftilde)/dx = (dr/dx)^T R^-1 (y - beta0 I) and d(ssqr)/dx = sigma^2 (dr/dx)^T (2 (r^T R^-1 I - 1)/(I^T R^-1 I) R^-1 I - 2 R^-1 r)
+ *
+ */
+
+void KrigingModel::interpolateWithGradients(rowvec xp, double *ftildeOutput, double *sSqrOutput, rowvec &gradientEstimate, rowvec &gradientVariance) const{
+
+	assert(ifInitialized);
+
+	unsigned int dim = data.getDimension();
+
+	vec r = correlationFunction.computeCorrelationVector(xp);
+	mat drdx = correlationFunction.computeCorrelationVectorGradient(xp, r);
+
+	double estimateLinearRegression = 0.0;
+	gradientEstimate = zeros<rowvec>(dim);
+
+	if(ifUsesLinearRegression ){
+
+		estimateLinearRegression = linearModel.interpolate(xp);
+
+		vec weights = linearModel.getWeights();
+		gradientEstimate = trans(weights.tail(dim));
+	}
+
+	*ftildeOutput = estimateLinearRegression + beta0 + dot(r,R_inv_ys_min_beta);
+	gradientEstimate += trans(R_inv_ys_min_beta)*drdx;
+
+	vec L_inv_r = linearSystemCorrelationMatrix.forwardSubstitution(r);
+	vec R_inv_r = linearSystemCorrelationMatrix.backwardSubstitution(L_inv_r);
+
+	double dotRTRinvR = dot(L_inv_r,L_inv_r);
+	double dotRTRinvI = dot(L_inv_r,L_inv_I);
+
+	double term1 = pow( (dotRTRinvI - 1.0 ),2.0)/dotITRinvI;
+	rowvec gradientTerm1 = (2.0*(dotRTRinvI - 1.0)/dotITRinvI)*(trans(R_inv_I)*drdx);
+
+	if(fabs(dotRTRinvI - 1.0) < 10E-10) {
+
+		term1 = 0.0;
+		gradientTerm1.zeros();
+	}
+
+	double term2 = 1.0 - dotRTRinvR;
+	rowvec gradientTerm2 = -2.0*(trans(R_inv_r)*drdx);
+
+	if(fabs(dotRTRinvR - 1.0) < 10E-10) {
+
+		term2 = 0.0;
+		gradientTerm2.zeros();
+	}
+
+	*sSqrOutput = sigmaSquared*(term2 + term1);
+	gradientVariance = sigmaSquared*(gradientTerm2 + gradientTerm1);
+
+}
+
+/** Evaluates the model for all rows of X. The correlation vectors of a block of points are computed
+ * in one pass and the variances need only a single forward substitution with many right hand sides
+ *
+ */
+
+void KrigingModel::interpolateBatch(const mat &X, vec &estimates, vec *variances) const{
+
+	assert(ifInitialized);
+	assert(X.n_cols == data.getDimension());
+
+	unsigned int numberOfPoints = X.n_rows;
+
+	/* points are processed in blocks to limit the size of the N x blockSize correlation matrix */
+	const unsigned int blockSize = 1024;
+
+	estimates.set_size(numberOfPoints);
+
+	if(variances != NULL){
+
+		variances->set_size(numberOfPoints);
+	}
+
+	for(unsigned int blockStart = 0; blockStart < numberOfPoints; blockStart += blockSize){
+
+		unsigned int blockEnd = std::min(blockStart + blockSize, numberOfPoints);
+
+		mat Xblock = X.rows(blockStart, blockEnd-1);
+
+		/* N x M, column m is the correlation vector r of the point m */
+		mat correlations = correlationFunction.computeCorrelationMatrixForPoints(Xblock);
+
+		vec estimatesBlock = beta0 + trans(correlations)*R_inv_ys_min_beta;
+
+		if(ifUsesLinearRegression ){
+
+			estimatesBlock += linearModel.interpolateAll(Xblock);
+		}
+
+		estimates.subvec(blockStart, blockEnd-1) = estimatesBlock;
+
+		if(variances != NULL){
+
+			/* r^T R^-1 r = || L^-1 r ||^2 */
+			mat L_inv_r = linearSystemCorrelationMatrix.forwardSubstitution(correlations);
+
+			rowvec dotRTRinvR = sum(square(L_inv_r),0);
+			vec dotRTRinvI = trans(L_inv_r)*L_inv_I;
+
+			for(unsigned int m=0; m<blockEnd-blockStart; m++){
+
+				double term1 = pow( (dotRTRinvI(m) - 1.0 ),2.0)/dotITRinvI;
+
+				if(fabs(dotRTRinvI(m) - 1.0) < 10E-10) {
+
+					term1 = 0.0;
+				}
+
+				double term2 = 1.0 - dotRTRinvR(m);
+
+				if(fabs(dotRTRinvR(m) - 1.0) < 10E-10) {
+
+					term2 = 0.0;
+				}
+
+				(*variances)(blockStart+m) = sigmaSquared*(term1 + term2);
+			}
+
+		}
+
+	}
+
+}
+
 mat KrigingModel::getCorrelationMatrix(void) const{
 
 	return linearSystemCorrelationMatrix.getMatrix();
@@ -678,10 +1005,180 @@ double KrigingModel::calculateLikelihoodFunction(vec hyperParameters){
 
 }
 
+/** Computes the concentrated log likelihood and its gradient with respect to the hyperparameters (theta, gamma)
+ * dL/dp = 1/2 tr( (alpha alpha^T / sigma^2 - R^-1) dR/dp ), alpha = R^-1 (ys - beta0 I)
+ * @param[in] hyperParameters
+ * @param[out] gradient
+ *
+ */
+
+double KrigingModel::calculateLikelihoodFunctionAndGradient(vec hyperParameters, vec &gradient){
+
+	double likelihoodValue = calculateLikelihoodFunction(hyperParameters);
+
+	gradient = zeros<vec>(hyperParameters.size());
+
+	if(linearSystemCorrelationMatrix.isFactorizationDone() == false || sigmaSquared <= 0.0){
+
+		return likelihoodValue;
+	}
+
+	/* R^-1 from the existing factor (potri) instead of N triangular solve pairs */
+	mat R_inv = linearSystemCorrelationMatrix.calculateInverse();
+
+	mat weights = (1.0/sigmaSquared)*R_inv_ys_min_beta*trans(R_inv_ys_min_beta) - R_inv;
+
+	gradient = correlationFunction.computeWeightedHyperParameterDerivatives(weights);
+
+	return likelihoodValue;
+
+}
+
+void KrigingModel::setGradientBasedTrainingOn(void){
+
+	ifUsesGradientBasedTraining = true;
+
+}
+
+void KrigingModel::setGradientBasedTrainingOff(void){
+
+	ifUsesGradientBasedTraining = false;
+
+}
+
+void KrigingModel::setNumberOfStartingPointsForGradientBasedTraining(unsigned int value){
+
+	assert(value>0);
+	numberOfStartingPointsForGradientBasedTraining = value;
+
+}
+
+/** Trains the hyperparameters by a bounded quasi-Newton (BFGS) method using the analytical gradient of the likelihood.
+ * The optimizer is started from the current hyperparameters and from the best points of a LHS design within the bounds,
+ * the number of training iterations is used as the total budget of likelihood evaluations (including the LHS points)
+ *
+ */
+
+void KrigingModel::trainWithGradientBasedMultiStart(void){
+
+	assert(ifInitialized);
+
+	/* distances between the samples do not change during the training, the copies of the model share the cache */
+	correlationFunction.buildDistanceCache();
+
+	unsigned int dim = data.getDimension();
+	assert(dim>0);
+
+	vec lb(2*dim,fill::zeros);
+	vec ub(2*dim);
+
+	for(unsigned int i=0; i<dim; i++)     ub(i) = 10.0;
+	for(unsigned int i=dim; i<2*dim; i++) ub(i) = 2.0;
+
+	Bounds boxConstraintsForTheTraining(lb,ub);
+
+	unsigned int numberOfStartingPoints = numberOfStartingPointsForGradientBasedTraining;
+
+	omp_set_num_threads(numberOfThreads);
+
+	/* the likelihood is evaluated at the points of a LHS design, the best of them are used as starting points */
+	unsigned int numberOfLHSPoints = std::max(5*numberOfStartingPoints, 2*dim + 1);
+
+	LHSSamples samplesForTheStartingPoints(2*dim, lb, ub, numberOfLHSPoints);
+	mat LHSPoints = trans(samplesForTheStartingPoints.getSamples());
+
+	vec likelihoodValuesLHSPoints(numberOfLHSPoints);
+
+#pragma omp parallel
+	{
+		/* a copy of the model for each thread, the copies share the data and the distance cache */
+		KrigingModel modelForCalculations = *this;
+
+#pragma omp for schedule(dynamic)
+		for(unsigned int i=0; i<numberOfLHSPoints; i++){
+
+			likelihoodValuesLHSPoints(i) = modelForCalculations.calculateLikelihoodFunction(LHSPoints.col(i));
+		}
+	}
+
+	uvec orderOfLHSPoints = sort_index(likelihoodValuesLHSPoints, "descend");
+
+	mat startingPoints(2*dim, numberOfStartingPoints);
+	startingPoints.col(0) = correlationFunction.getHyperParameters();
+
+	for(unsigned int i=1; i<numberOfStartingPoints; i++){
+
+		startingPoints.col(i) = LHSPoints.col(orderOfLHSPoints(i-1));
+	}
+
+	unsigned int numberOfEvaluationsPerStart = 0;
+
+	if(numberOfTrainingIterations > numberOfLHSPoints){
+
+		numberOfEvaluationsPerStart = (numberOfTrainingIterations - numberOfLHSPoints)/numberOfStartingPoints;
+	}
+
+	if(numberOfEvaluationsPerStart < 10){
+
+		numberOfEvaluationsPerStart = 10;
+	}
+
+	double bestObjectiveFunctionValue = LARGE;
+	vec bestHyperParameters = startingPoints.col(0);
+
+#pragma omp parallel for schedule(dynamic)
+	for(unsigned int i=0; i<numberOfStartingPoints; i++){
+
+		KrigingHyperParameterGradientOptimizer parameterOptimizer;
+
+		parameterOptimizer.setDimension(2*dim);
+		parameterOptimizer.setBounds(boxConstraintsForTheTraining);
+		parameterOptimizer.initializeKrigingModelObject(*this);
+		parameterOptimizer.setInitialPoint(startingPoints.col(i));
+		parameterOptimizer.setBFGSUpdateOn();
+		parameterOptimizer.setMaximumStepSize(1.0);
+		parameterOptimizer.setTolerance(10E-6);
+		parameterOptimizer.setMaximumNumberOfFunctionEvaluations(numberOfEvaluationsPerStart);
+
+		parameterOptimizer.optimize();
+
+#pragma omp critical
+		{
+			double objectiveFunctionValue = parameterOptimizer.getOptimalObjectiveFunctionValue();
+
+			if(objectiveFunctionValue < bestObjectiveFunctionValue){
+
+				bestObjectiveFunctionValue = objectiveFunctionValue;
+				bestHyperParameters = parameterOptimizer.getOptimalDesignVector();
+			}
+		}
+	}
+
+	omp_set_num_threads(1);
+
+	output.printMessage("Best likelihood value = ", -bestObjectiveFunctionValue);
+
+	correlationFunction.clearDistanceCache();
+	correlationFunction.setHyperParameters(bestHyperParameters);
+
+	updateAuxilliaryFields();
+	ifModelTrainingIsDone = true;
+
+}
+
 void KrigingModel::train(void){
 
 	assert(ifInitialized);
 
+	/* hyperparameters are trained only with the true samples */
+	removePendingSamples();
+
+	if(ifUsesGradientBasedTraining){
+
+		trainWithGradientBasedMultiStart();
+		return;
+	}
+
 	unsigned int dim = data.getDimension();
 	assert(dim>0);
 
@@ -696,6 +1193,9 @@ void KrigingModel::train(void){
 	boxConstraintsForTheTraining.setBounds(lb,ub);
 	double globalBestL1error = LARGE;
 
+	/* distances between the samples do not change during the training, the copies of the model share the cache */
+	correlationFunction.buildDistanceCache();
+
 	KrigingHyperParameterOptimizer bestOptimizer;
 	omp_set_num_threads(numberOfThreads);
 
@@ -755,6 +1255,9 @@ void KrigingModel::train(void){
 
 	omp_set_num_threads(1);
 
+	/* the cache is freed when bestOptimizer (the last copy of the model) goes out of scope */
+	correlationFunction.clearDistanceCache();
+
 	if(ifWriteWarmStartFile){
 
 		bestOptimizer.setFilenameWarmStart(filenameForWriteWarmStart);
@@ -768,20 +1271,86 @@ void KrigingModel::train(void){
 
 }
 
-void KrigingHyperParameterOptimizer::initializeKrigingModelObject(KrigingModel input){
+KrigingHyperParameterOptimizer::KrigingHyperParameterOptimizer(){
+
+	ifObjectiveFunctionIsReentrant = true;
+
+}
+
+void KrigingHyperParameterOptimizer::initializeKrigingModelObject(const KrigingModel &input){
 
 	assert(input.ifDataIsRead);
 	assert(input.ifNormalized);
 	assert(input.ifInitialized);
 
-	KrigingModelForCalculations = input;
+	KrigingModelsForCalculations.assign(1, input);
 
 	ifModelObjectIsSet = true;
 
 }
 
+void KrigingHyperParameterOptimizer::prepareObjectiveFunctionForThreads(unsigned int numberOfThreads){
+
+	assert(ifModelObjectIsSet);
+	assert(numberOfThreads > 0);
+
+	if(numberOfThreads > KrigingModelsForCalculations.size()){
+
+		/* the copies share the data and the distance cache with the first model */
+		KrigingModel model = KrigingModelsForCalculations[0];
+		KrigingModelsForCalculations.resize(numberOfThreads, model);
+	}
+	else{
+
+		KrigingModelsForCalculations.resize(numberOfThreads);
+	}
+}
+
+/* outside of the parallel evaluation of a group there is no concurrent call, then the first copy is used */
 double KrigingHyperParameterOptimizer::calculateObjectiveFunctionInternal(vec& input){
 
-	return -1.0* KrigingModelForCalculations.calculateLikelihoodFunction(input);
+	unsigned int thread = omp_get_thread_num();
+
+	if(thread >= KrigingModelsForCalculations.size()) thread = 0;
+
+	return -1.0* KrigingModelsForCalculations[thread].calculateLikelihoodFunction(input);
+
+}
+
+
+void KrigingHyperParameterGradientOptimizer::initializeKrigingModelObject(const KrigingModel &input){
+
+	assert(input.ifDataIsRead);
+	assert(input.ifNormalized);
+	assert(input.ifInitialized);
+
+	KrigingModelForCalculations = input;
+
+	ifModelObjectIsSet = true;
+
+}
+
+double KrigingHyperParameterGradientOptimizer::calculateObjectiveFunctionInternal(vec& input){
+
+	assert(ifModelObjectIsSet);
+
+	vec gradient;
+	double likelihoodValue = KrigingModelForCalculations.calculateLikelihoodFunctionAndGradient(input, gradient);
+
+	lastEvaluatedInput = input;
+	lastEvaluatedGradient = -1.0*gradient;
+
+	return -1.0*likelihoodValue;
+
+}
+
+vec KrigingHyperParameterGradientOptimizer::calculateGradientFunctionInternal(vec input){
+
+	if(lastEvaluatedInput.size() != input.size() || any(lastEvaluatedInput != input)){
+
+		calculateObjectiveFunctionInternal(input);
+	}
+
+	return lastEvaluatedGradient;
 
 }
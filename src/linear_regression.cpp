@@ -206,7 +206,7 @@ double LinearModel::interpolate(rowvec x ) const{
 void LinearModel::interpolateWithVariance(rowvec xp,double *f_tilde,double *ssqr) const{
 	assert(false);
 }
-double LinearModel::interpolateWithGradients(rowvec xp) const{
+void LinearModel::interpolateWithGradients(rowvec xp, double *f_tilde, double *ssqr, rowvec &gradientEstimate, rowvec &gradientVariance) const{
 
 	cout << "ERROR: interpolateWithGradients does not exist for LinearModel\n";
 	abort();
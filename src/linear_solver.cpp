@@ -79,7 +79,7 @@ mat CholeskySystem::getLowerDiagonalMatrix(void) const{
 
 mat CholeskySystem::getUpperDiagonalMatrix(void) const{
 
-	return U;
+	return trans(L);
 
 }
 
@@ -89,9 +89,9 @@ double CholeskySystem::calculateDeterminant(void){
 	double determinant = 0.0;
 
 
-	vec U_diagonal = U.diag();
+	vec L_diagonal = L.diag();
 
-	determinant = prod(U_diagonal);
+	determinant = prod(L_diagonal);
 
 
 	return determinant*determinant;
@@ -104,11 +104,11 @@ double CholeskySystem::calculateLogDeterminant(void){
 
 	double determinant = 0.0;
 
-	vec U_diagonal = U.diag();
+	vec L_diagonal = L.diag();
 
 	for(unsigned int i=0; i<dimension; i++) {
 
-		determinant+= log(U_diagonal(i));
+		determinant+= log(L_diagonal(i));
 	}
 
 	return 2.0*determinant;
@@ -156,8 +156,6 @@ void CholeskySystem::factorize(void){
 	}
 	else{
 
-		U = trans(L);
-
 		ifFactorizationIsDone = true;
 	}
 
@@ -166,71 +164,139 @@ void CholeskySystem::factorize(void){
 
 }
 
-vec CholeskySystem::forwardSubstitution(vec rhs) const{
+/** Extends the matrix A by a new row and column and updates the Cholesky factor in O(N^2)
+ * (border update), instead of refactorizing the extended matrix from scratch
+ * @param[in] newColumn: last column of the extended matrix, the last entry is the diagonal entry
+ *
+ */
 
+void CholeskySystem::addRowAndColumn(vec newColumn){
 
-	vec x(dimension);
-	x.fill(0.0);
+	assert(ifFactorizationIsDone);
+	assert(newColumn.size() == dimension+1);
 
-	for (unsigned int i=0; i<dimension; i++){
+	vec offDiagonalPart = newColumn.head(dimension);
+	double diagonalEntry = newColumn(dimension);
 
-		double sum = 0.0;
-		for (unsigned int j=0; j<i; j++){
+	/* solve L l = a for the new row of L */
+	vec l = forwardSubstitution(offDiagonalPart);
 
-			sum += x(j)*L(i,j);
+	double pivot = diagonalEntry - dot(l,l);
 
-		}
+	A.resize(dimension+1,dimension+1);
+	A.col(dimension) = newColumn;
+	A.row(dimension) = trans(newColumn);
 
-		x(i) = (rhs(i) - sum)/L(i,i);
+	L.resize(dimension+1,dimension+1);
+	dimension++;
 
+	if(pivot <= 0.0){
 
+		/* extended matrix is not (numerically) positive definite */
+		ifFactorizationIsDone = false;
+		return;
 	}
 
+	/* resize keeps the old entries and sets the new ones to zero */
+	L.submat(dimension-1, 0, dimension-1, dimension-2) = trans(l);
+	L(dimension-1,dimension-1) = sqrt(pivot);
+
+}
 
+/* triangular solves are done by LAPACK (trtrs) through Armadillo, the rcond check is skipped (solve_opts::fast)
+ * since the correlation matrices are often badly conditioned */
 
-	return x;
+mat CholeskySystem::forwardSubstitution(const mat &rhs) const{
+
+	assert(rhs.n_rows == dimension);
+
+	return solve(trimatl(L), rhs, solve_opts::fast);
 }
 
-vec CholeskySystem::backwardSubstitution(vec rhs) const{
+mat CholeskySystem::backwardSubstitution(const mat &rhs) const{
 
-	vec x(dimension);
-	x.fill(0.0);
+	assert(rhs.n_rows == dimension);
 
-	for (int i=dimension-1; i>=0; i--){
+	mat solution = rhs;
 
-		double sum = 0.0;
-		for (unsigned int j=i+1; j<dimension; j++){
+	if(solution.n_elem == 0) return solution;
 
-			sum += x(j)*U(i,j);
+	/* L^T x = rhs is solved with L itself (trans = 'T'), the transpose of L is never formed */
+	char uplo  = 'L';
+	char op    = 'T';
+	char diag  = 'N';
+	blas_int n    = blas_int(dimension);
+	blas_int nrhs = blas_int(solution.n_cols);
+	blas_int info = 0;
 
-		}
+	arma::lapack::trtrs(&uplo, &op, &diag, &n, &nrhs, L.memptr(), &n, solution.memptr(), &n, &info);
 
-		x(i) = (rhs(i) - sum)/U(i,i);
+	if(info != 0){
 
+		abortWithErrorMessage("CholeskySystem::backwardSubstitution: trtrs has failed");
 	}
 
-	return x;
+	return solution;
 }
 
-vec CholeskySystem::solveLinearSystem(vec rhs) const{
+/** Inverse of A from the existing Cholesky factor (LAPACK potri), no further solves or refactorization
+ *
+ */
+
+mat CholeskySystem::calculateInverse(void) const{
 
 	assert(ifFactorizationIsDone);
 
-	vec v(dimension);
-	vec x(dimension);
+	mat inverse = L;
+
+	char uplo = 'L';
+	blas_int n = blas_int(dimension);
+	blas_int info = 0;
+
+	/* only the lower triangle is referenced and overwritten */
+	arma::lapack::potri(&uplo, &n, inverse.memptr(), &n, &info);
+
+	if(info != 0){
+
+		abortWithErrorMessage("CholeskySystem::calculateInverse: potri has failed");
+	}
+
+	return symmatl(inverse);
+}
+
+vec CholeskySystem::solveLinearSystem(const vec &rhs) const{
+
+	assert(ifFactorizationIsDone);
 
 	/* solve L v = rhs */
-	v = forwardSubstitution(rhs);
-	/* solve U x = v */
-	x = backwardSubstitution(v);
+	vec v = forwardSubstitution(rhs);
+	/* solve L^T x = v */
+	vec x = backwardSubstitution(v);
 
 	return x;
 }
 
+/** Solves the system A X = B for all columns of B at once
+ * @param[in] rhs: right hand sides B (one column for each system)
+ *
+ */
+
+mat CholeskySystem::solveLinearSystem(const mat &rhs) const{
+
+	assert(ifFactorizationIsDone);
+
+	/* solve L V = B */
+	mat V = forwardSubstitution(rhs);
+	/* solve L^T X = V */
+	mat X = backwardSubstitution(V);
+
+	return X;
+}
+
 
 
 
-void SVDSystem::setMatrix(mat input){
+void SVDSystem::setMatrix(const mat &input){
 
 	assert(input.n_rows!=0);
 	assert(input.n_cols!=0);
@@ -245,7 +311,8 @@ void SVDSystem::factorize(void){
 
 	assert(ifMatrixIsSet);
 
-	svd(U,sigma,V,A);
+	/* thin SVD, only the first min(m,n) columns of U are needed for the least squares solution */
+	svd_econ(U,sigma,V,A);
 
 	ifFactorizationIsDone = true;
 
@@ -35,6 +35,8 @@
 #include "matrix_vector_operations.hpp"
 #include "auxiliary_functions.hpp"
 #include "random_functions.hpp"
+#include "binary_data_file.hpp"
+#include <limits>
 
 #define ARMA_DONT_PRINT_ERRORS
 #include <armadillo>
@@ -182,26 +184,51 @@ void joinMatricesByRows(mat& A, const mat& B){
 
 }
 
+/* the rows are appended in place if the file is a binary data file */
+
 void appendMatrixToCSVData(const mat& A, std::string fileName){
 
-	unsigned int nRows = A.n_rows;
+	if(BinaryDataFile::checkIfBinaryDataFile(fileName)){
+
+		BinaryDataFile dataFile(fileName);
+		dataFile.appendRows(A);
+		return;
+	}
+
+	std::ofstream outfile;
+
+	outfile.open(fileName, std::ios_base::app); // append instead of overwrite
+
+	outfile.precision(std::numeric_limits<double>::max_digits10);
 
-	for(unsigned int i=0; i<nRows; i++){
+	for(unsigned int i=0; i<A.n_rows; i++){
+
+		for(unsigned int j=0; j<A.n_cols-1; j++){
 
-		appendRowVectorToCSVData(A.row(i),fileName);
+			outfile << A(i,j) <<",";
+		}
+		outfile << A(i,A.n_cols-1)<<"\n";
 	}
 
+	outfile.close();
 
 }
 
 void appendRowVectorToCSVData(rowvec v, std::string fileName){
 
+	if(BinaryDataFile::checkIfBinaryDataFile(fileName)){
+
+		BinaryDataFile dataFile(fileName);
+		dataFile.appendRow(v);
+		return;
+	}
 
 	std::ofstream outfile;
 
 	outfile.open(fileName, std::ios_base::app); // append instead of overwrite
 
-	outfile.precision(10);
+	/* enough digits to read back the same double */
+	outfile.precision(std::numeric_limits<double>::max_digits10);
 	for(unsigned int i=0; i<v.size()-1; i++){
 
 		outfile << v(i) <<",";
@@ -219,6 +246,11 @@ mat readMatFromCVSFile(std::string fileName){
 
 	assert(!fileName.empty());
 
+	if(BinaryDataFile::checkIfBinaryDataFile(fileName)){
+
+		BinaryDataFile dataFile(fileName);
+		return dataFile.read();
+	}
 
 	mat dataBuffer;
 	bool isReadOk  = dataBuffer.load(fileName,csv_ascii);
@@ -241,7 +273,7 @@ void saveMatToCVSFile(mat M, std::string fileName){
 
 
 	std::ofstream samplesFile(fileName);
-	samplesFile.precision(15);
+	samplesFile.precision(std::numeric_limits<double>::max_digits10);
 
 	if (samplesFile.is_open())
 	{
@@ -37,8 +37,21 @@
 
 
 
+WeightedL1NormOptimizer::WeightedL1NormOptimizer(){
+
+	ifObjectiveFunctionIsReentrant = true;
+
+}
+
+/* outside of the parallel evaluation of a group there is no concurrent call, then the first copy is used */
 double WeightedL1NormOptimizer::calculateObjectiveFunctionInternal(vec& input){
 
+	unsigned int thread = omp_get_thread_num();
+
+	if(thread >= weightedL1NormsForCalculations.size()) thread = 0;
+
+	WeightedL1Norm &weightedL1NormForCalculations = weightedL1NormsForCalculations[thread];
+
 	weightedL1NormForCalculations.setWeights(input);
 
 	double meanL1Error = weightedL1NormForCalculations.calculateMeanL1ErrorOnData();
@@ -51,11 +64,27 @@ void WeightedL1NormOptimizer::initializeWeightedL1NormObject(WeightedL1Norm inpu
 	assert(input.getDimension() > 0);
 	assert(input.isTrainingDataSet());
 	assert(input.isValidationDataSet());
-	weightedL1NormForCalculations = input;
+	weightedL1NormsForCalculations.assign(1, input);
 	ifWeightedL1NormForCalculationsIsSet = true;
 
 }
 
+void WeightedL1NormOptimizer::prepareObjectiveFunctionForThreads(unsigned int numberOfThreads){
+
+	assert(ifWeightedL1NormForCalculationsIsSet);
+	assert(numberOfThreads > 0);
+
+	if(numberOfThreads > weightedL1NormsForCalculations.size()){
+
+		WeightedL1Norm norm = weightedL1NormsForCalculations[0];
+		weightedL1NormsForCalculations.resize(numberOfThreads, norm);
+	}
+	else{
+
+		weightedL1NormsForCalculations.resize(numberOfThreads);
+	}
+}
+
 
 
 bool WeightedL1NormOptimizer::isWeightedL1NormForCalculationsSet(void) const{
@@ -202,6 +231,34 @@ double WeightedL1Norm::calculateNorm(const rowvec &x) const{
 	return sum;
 }
 
+double WeightedL1Norm::calculateNorm(const subview_row<double> &x) const{
+
+	double sum = 0.0;
+	for(unsigned int i=0; i<x.n_elem; i++){
+
+		sum += weights(i)*fabs(x(i));
+
+	}
+
+	return sum;
+}
+
+/* weighted L1 distance of two points given as contiguous arrays of length "dimension" */
+
+double WeightedL1Norm::calculateDistance(const double *x_i, const double *x_j) const{
+
+	const double *weightsPtr = weights.memptr();
+
+	double sum = 0.0;
+	for(unsigned int i=0; i<dimension; i++){
+
+		sum += weightsPtr[i]*fabs(x_i[i] - x_j[i]);
+
+	}
+
+	return sum;
+}
+
 void WeightedL1Norm::generateRandomWeights(void){
 
 
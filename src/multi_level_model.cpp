@@ -82,6 +82,13 @@ void MultiLevelModel::setNumberOfTrainingIterations(unsigned int nIter){
 
 }
 
+void MultiLevelModel::setGradientBasedTrainingOn(void){
+
+	lowFidelityModel->setGradientBasedTrainingOn();
+	errorModel->setGradientBasedTrainingOn();
+
+}
+
 void MultiLevelModel::setinputFileNameHighFidelityData(string filename){
 
 	assert(isNotEmpty(filename));
@@ -474,6 +481,41 @@ void MultiLevelModel::interpolateWithVariance(rowvec xp,double *estimatedValue,d
 }
 
 
+/* both models are evaluated in batch, the variance is taken from the low fidelity model as in interpolateWithVariance */
+
+void MultiLevelModel::interpolateBatch(const mat &X, vec &estimates, vec *variances) const{
+
+	unsigned int numberOfPoints = X.n_rows;
+
+	vec lowFidelityEstimates;
+	vec errorEstimates;
+
+	lowFidelityModel->interpolateBatch(X, lowFidelityEstimates, variances);
+	errorModel->interpolateBatch(X, errorEstimates);
+
+	estimates.set_size(numberOfPoints);
+
+#pragma omp parallel for schedule(static)
+	for(unsigned int i=0; i<numberOfPoints; i++){
+
+		rowvec x = X.row(i);
+
+		double distanceToHF = findNearestL1DistanceToAHighFidelitySample(x);
+		double distanceToLF = findNearestL1DistanceToALowFidelitySample(x);
+
+		double alpha = 1.0;
+
+		if(distanceToLF < distanceToHF){
+
+			alpha = exp(-gamma*distanceToHF);
+		}
+
+		estimates(i) = lowFidelityEstimates(i) + alpha*errorEstimates(i);
+	}
+
+}
+
+
 void MultiLevelModel::readHighFidelityData(void){
 
 	assert(ifInputFileNameForHiFiModelIsSet);
@@ -36,6 +36,7 @@
 #include <iostream>
 #include <unistd.h>
 #include <cassert>
+#include <mutex>
 #include "auxiliary_functions.hpp"
 #include "Rodeo_macros.hpp"
 #include "Rodeo_globals.hpp"
@@ -111,6 +112,8 @@ void ObjectiveFunctionDefinition::print(void) const{
 	std::cout<< "Path = " << path << "\n";
 	std::cout<< "Surrogate model = " << modelHiFi << "\n";
 	std::cout<< "Multilevel = "<<ifMultiLevel<<"\n";
+	std::cout<< "Worker mode = "<<ifWorkerMode<<"\n";
+	std::cout<< "Gradient based model training = "<<ifGradientBasedModelTraining<<"\n";
 
 	if(ifMultiLevel){
 		std::cout<< "Low fidelity model = " << "\n";
@@ -246,6 +249,14 @@ std::string ObjectiveFunction::getFileNameDesignVector(void) const{
 	return definition.designVectorFilename;
 }
 
+std::string ObjectiveFunction::getFileNameOutput(void) const{
+	return definition.outputFilename;
+}
+
+bool ObjectiveFunction::checkIfWorkerModeIsOn(void) const{
+	return definition.ifWorkerMode;
+}
+
 std::string ObjectiveFunction::getFileNameTrainingData(void) const{
 	return definition.nameHighFidelityTrainingData;
 }
@@ -313,6 +324,11 @@ void ObjectiveFunction::initializeSurrogate(void){
 	surrogate->initializeSurrogateModel();
 	surrogate->setNumberOfTrainingIterations(numberOfIterationsForSurrogateTraining);
 
+	if(definition.ifGradientBasedModelTraining){
+
+		surrogate->setGradientBasedTrainingOn();
+	}
+
 #if 0
 	surrogate->printSurrogateModel();
 #endif
@@ -366,35 +382,69 @@ void ObjectiveFunction::calculateExpectedImprovement(DesignForBayesianOptimizati
 
 	double	sigma = sqrt(ssqr)	;
 
-#if 0
-	printf("standart_ERROR = %15.10f\n",sigma);
-#endif
+	designCalculated.valueAcqusitionFunction = calculateExpectedImprovementValue(ftilde, sigma);
+	designCalculated.objectiveFunctionValue = ftilde;
+	designCalculated.sigma = sigma;
+}
+
+/** EI = (yMin - ftilde) Phi(Z) + sigma phi(Z) with Z = (yMin - ftilde)/sigma
+ * @param[in] ftilde: surrogate estimate
+ * @param[in] sigma: standard deviation of the estimate
+ *
+ */
+
+double ObjectiveFunction::calculateExpectedImprovementValue(double ftilde, double sigma) const{
 
 	double expectedImprovementValue = 0.0;
 
 	if(fabs(sigma) > EPSILON){
 
-		double improvement = 0.0;
-		improvement = yMin   - ftilde;
-
+		double improvement = yMin - ftilde;
 		double	Z = (improvement)/sigma;
-#if 0
-		printf("Z = %15.10f\n",Z);
-		printf("ymin = %15.10f\n",yMin);
-#endif
 
 		expectedImprovementValue = improvement*cdf(Z,0.0,1.0)+  sigma * pdf(Z,0.0,1.0);
+	}
 
+	return expectedImprovementValue;
+}
 
-	}
-	else{
 
-		expectedImprovementValue = 0.0;
+/** Computes the expected improvement and its analytic gradient, dEI/dx = -Phi(Z) dftilde/dx + phi(Z) dsigma/dx.
+ * The gradient is written to designCalculated.gradientAcqusitionFunction
+ *
+ */
+
+void ObjectiveFunction::calculateExpectedImprovementWithGradient(DesignForBayesianOptimization &designCalculated) const{
 
-	}
+	double ftilde, ssqr;
+	rowvec gradientEstimate;
+	rowvec gradientVariance;
 
+	surrogate->interpolateWithGradients(designCalculated.dv, &ftilde, &ssqr, gradientEstimate, gradientVariance);
+
+	double	sigma = sqrt(ssqr)	;
+
+	double expectedImprovementValue = 0.0;
+	rowvec gradientExpectedImprovement(designCalculated.dv.size(), fill::zeros);
+
+	if(fabs(sigma) > EPSILON){
+
+		double improvement = yMin   - ftilde;
+
+		double	Z = (improvement)/sigma;
+
+		double cdfZ = cdf(Z,0.0,1.0);
+		double pdfZ = pdf(Z,0.0,1.0);
+
+		expectedImprovementValue = improvement*cdfZ +  sigma * pdfZ;
+
+		/* dsigma/dx = (dssqr/dx)/(2 sigma) */
+		gradientExpectedImprovement = -cdfZ*gradientEstimate + (pdfZ/(2.0*sigma))*gradientVariance;
+
+	}
 
 	designCalculated.valueAcqusitionFunction = expectedImprovementValue;
+	designCalculated.gradientAcqusitionFunction = gradientExpectedImprovement;
 	designCalculated.objectiveFunctionValue = ftilde;
 	designCalculated.sigma = sigma;
 }
@@ -491,14 +541,66 @@ void ObjectiveFunction::addLowFidelityDesignToData(Design &d){
 	surrogate->addNewLowFidelitySampleToData(newsample);
 }
 
+/* pending designs are supported only by the Kriging model */
+
+bool ObjectiveFunction::checkIfPendingDesignsAreSupported(void) const{
+
+	assert(ifSurrogateModelIsDefined);
+
+	if(surrogate == &surrogateModel) return true;
+	else return false;
+}
+
+/** Adds a design that is being evaluated to the surrogate model with a fictitious output.
+ *
+ * @param[in] x: normalized design vector
+ * @param[in] ifConstantLiar: if true the minimum output value of the data is used (constant liar),
+ * otherwise the estimate of the model (Kriging believer)
+ */
+
+void ObjectiveFunction::addPendingDesign(rowvec x, bool ifConstantLiar){
+
+	assert(ifInitialized);
+	assert(checkIfPendingDesignsAreSupported());
+
+	double fictitiousValue;
+
+	if(ifConstantLiar){
+
+		fictitiousValue = min(surrogate->getRawData().col(dim));
+	}
+	else{
+
+		fictitiousValue = surrogateModel.interpolate(x);
+	}
+
+	surrogateModel.addPendingSample(x, fictitiousValue);
+
+}
+
+void ObjectiveFunction::removePendingDesigns(void){
+
+	if(checkIfPendingDesignsAreSupported()){
+
+		surrogateModel.removePendingSamples();
+	}
+}
+
 
 rowvec ObjectiveFunction::readOutput(unsigned int howMany) const{
 
 	assert(isNotEmpty(definition.outputFilename));
 
+	return readOutputFromFile(definition.outputFilename, howMany);
+}
+
+rowvec ObjectiveFunction::readOutputFromFile(std::string filename, unsigned int howMany) const{
+
+	assert(isNotEmpty(filename));
+
 	rowvec result(howMany,fill::zeros);
 
-	std::ifstream inputFileStream(definition.outputFilename);
+	std::ifstream inputFileStream(filename);
 
 	if (!inputFileStream.is_open()) {
 		abortWithErrorMessage("There was a problem opening the output file!\n");
@@ -515,37 +617,45 @@ rowvec ObjectiveFunction::readOutput(unsigned int howMany) const{
 }
 
 
+unsigned int ObjectiveFunction::getNumberOfOutputValues(void) const{
+
+	if(evaluationMode.compare("tangent") == 0 ) return 2;
+	if(evaluationMode.compare("adjoint") == 0 ) return 1+dim;
+
+	return 1;
+}
+
 void ObjectiveFunction::readOutputDesign(Design &d) const{
 
-	if(evaluationMode.compare("primal") == 0 ){
+	rowvec outputs = readOutput(getNumberOfOutputValues());
+	assignAndCacheOutputs(d, outputs);
+
+}
 
-		rowvec functionalValue(1);
+void ObjectiveFunction::assignOutputsToDesign(Design &d, const rowvec &outputs) const{
 
-		functionalValue = readOutput(1);
-		d.trueValue = functionalValue(0);
+	assert(outputs.size() >= getNumberOfOutputValues());
+
+	if(evaluationMode.compare("primal") == 0 ){
+
+		d.trueValue = outputs(0);
 	}
 
 	if(evaluationMode.compare("tangent") == 0 ){
 
-		rowvec resultBuffer(2);
-
-		resultBuffer = readOutput(2);
-		d.trueValue = resultBuffer(0);
-		d.tangentValue = resultBuffer(1);
+		d.trueValue = outputs(0);
+		d.tangentValue = outputs(1);
 
 	}
 
 	if(evaluationMode.compare("adjoint") == 0 ){
 
-		rowvec resultBuffer(1+dim);
-
-		resultBuffer = readOutput(1+dim);
-		d.trueValue = resultBuffer(0);
+		d.trueValue = outputs(0);
 		rowvec gradient(dim,fill::zeros);
 
 		for(unsigned int i=0; i<dim; i++){
 
-			gradient(i) = resultBuffer(i+1);
+			gradient(i) = outputs(i+1);
 		}
 		d.gradient = gradient;
 
@@ -555,10 +665,17 @@ void ObjectiveFunction::readOutputDesign(Design &d) const{
 
 void ObjectiveFunction::writeDesignVariablesToFile(Design &d) const{
 
-	assert(d.designParameters.size() == dim);
 	assert(isNotEmpty(definition.designVectorFilename));
 
-	std::ofstream outputFileStream(definition.designVectorFilename);
+	writeDesignVariablesToFile(d, definition.designVectorFilename);
+}
+
+void ObjectiveFunction::writeDesignVariablesToFile(const Design &d, std::string filename) const{
+
+	assert(d.designParameters.size() == dim);
+	assert(isNotEmpty(filename));
+
+	std::ofstream outputFileStream(filename);
 
 	if (!outputFileStream.is_open()) {
 		abortWithErrorMessage("There was a problem opening the output file!\n");
@@ -586,11 +703,252 @@ void ObjectiveFunction::evaluateDesign(Design &d){
 
 	assert(d.designParameters.size() == dim);
 
-	writeDesignVariablesToFile(d);
-	evaluateObjectiveFunction();
-	readOutputDesign(d);
+	if(findOutputsInTheCache(d)){
+
+		output.printMessage("Outputs are taken from the evaluation cache for:", definition.name);
+		return;
+	}
+
+	if(definition.ifWorkerMode){
+
+		if(workers.empty()) setNumberOfJobSlots(1);
+
+		output.printMessage("Calling the worker for:", definition.name);
+		assignAndCacheOutputs(d, callWorker(d,0));
+	}
+	else if(sandbox){
+
+		std::string workingDirectory = sandbox->createJobDirectory(definition.name);
+
+		output.printMessage("Calling executable for the objective function:", definition.name);
+		evaluateDesignInDirectory(d, workingDirectory);
+
+		sandbox->finalizeJobDirectory(workingDirectory);
+	}
+	else{
+
+		writeDesignVariablesToFile(d);
+		evaluateObjectiveFunction();
+		readOutputDesign(d);
+	}
+
+}
+
+void ObjectiveFunction::setEvaluationSandbox(std::shared_ptr<EvaluationSandbox> sandboxToUse){
+
+	sandbox = sandboxToUse;
+}
+
+void ObjectiveFunction::setEvaluationCache(std::shared_ptr<EvaluationCache> cacheToUse){
+
+	cache = cacheToUse;
+}
+
+/* key of the design in the evaluation cache: name, evaluation mode, design vector and the tangent direction (tangent mode) */
+
+std::string ObjectiveFunction::generateCacheKey(const Design &d) const{
+
+	assert(d.designParameters.size() == dim);
+
+	std::vector<double> values(d.designParameters.begin(), d.designParameters.end());
+
+	if(evaluationMode.compare("tangent") == 0){
 
+		assert(d.tangentDirection.size() == dim);
+		values.insert(values.end(), d.tangentDirection.begin(), d.tangentDirection.end());
+	}
+
+	return EvaluationCache::generateKey(definition.name, evaluationMode, values);
 }
+
+/* assigns the outputs of an earlier evaluation of the same design, returns false if there is no cache or no entry */
+
+bool ObjectiveFunction::findOutputsInTheCache(Design &d) const{
+
+	if(!cache) return false;
+
+	std::vector<double> values;
+
+	if(!cache->find(generateCacheKey(d), values)) return false;
+	if(values.size() < getNumberOfOutputValues()) return false;
+
+	rowvec outputs(values);
+	assignOutputsToDesign(d, outputs);
+
+	return true;
+}
+
+void ObjectiveFunction::assignAndCacheOutputs(Design &d, const rowvec &outputs) const{
+
+	if(cache){
+
+		std::vector<double> values(outputs.begin(), outputs.begin() + getNumberOfOutputValues());
+		cache->add(generateCacheKey(d), values);
+	}
+
+	assignOutputsToDesign(d, outputs);
+}
+
+void ObjectiveFunction::setNumberOfJobSlots(unsigned int howMany){
+
+	assert(howMany > 0);
+
+	while(workers.size() < howMany){
+
+		workers.push_back(std::make_shared<SimulationWorker>());
+	}
+
+}
+
+unsigned int ObjectiveFunction::getNumberOfJobSlots(void) const{
+
+	return workers.size();
+}
+
+/** Evaluates a design on a job slot, can be called concurrently for different slots.
+ * In the worker mode every slot has its own worker process. The file-based evaluations
+ * run in the given working directory or in a job directory of the sandbox. Without both they
+ * share the file names in the current directory, therefore they are executed one at a time.
+ *
+ * @param[in,out] d: design to be evaluated
+ * @param[in] slot: index of the job slot
+ * @param[in] workingDirectory: private directory of the evaluation (optional)
+ * @return false if the outputs are taken from the evaluation cache, i.e. the executable is not called
+ */
+
+bool ObjectiveFunction::evaluateDesignOnJobSlot(Design &d, unsigned int slot, std::string workingDirectory) const{
+
+	assert(d.designParameters.size() == dim);
+
+	if(findOutputsInTheCache(d)) return false;
+
+	if(definition.ifWorkerMode){
+
+		assert(slot < workers.size());
+		assignAndCacheOutputs(d, callWorker(d,slot));
+	}
+	else if(isNotEmpty(workingDirectory)){
+
+		evaluateDesignInDirectory(d, workingDirectory);
+	}
+	else if(sandbox){
+
+		std::string jobDirectory = sandbox->createJobDirectory(definition.name);
+		evaluateDesignInDirectory(d, jobDirectory);
+		sandbox->finalizeJobDirectory(jobDirectory);
+	}
+	else{
+
+		static std::mutex fileBasedEvaluationMutex;
+		std::lock_guard<std::mutex> lock(fileBasedEvaluationMutex);
+
+		writeDesignVariablesToFile(d);
+
+		std::string runCommand = getExecutionCommand();
+		system(runCommand.c_str());
+
+		readOutputDesign(d);
+	}
+
+	return true;
+}
+
+/* writes the design vector to the working directory, runs the executable there and reads the output from the same directory */
+
+void ObjectiveFunction::evaluateDesignInDirectory(Design &d, std::string workingDirectory) const{
+
+	assert(isNotEmpty(workingDirectory));
+
+	writeDesignVariablesToDirectory(d, workingDirectory);
+	runExecutableInDirectory(workingDirectory);
+	readOutputDesignFromDirectory(d, workingDirectory);
+
+}
+
+/* the following three functions use the current directory if the working directory is empty */
+
+void ObjectiveFunction::writeDesignVariablesToDirectory(const Design &d, std::string workingDirectory) const{
+
+	assert(isNotEmpty(definition.designVectorFilename));
+
+	if(isNotEmpty(workingDirectory)) writeDesignVariablesToFile(d, workingDirectory + "/" + definition.designVectorFilename);
+	else writeDesignVariablesToFile(d, definition.designVectorFilename);
+
+}
+
+void ObjectiveFunction::runExecutableInDirectory(std::string workingDirectory) const{
+
+	assert(isNotEmpty(definition.executableName));
+
+	std::string runCommand;
+
+	if(isNotEmpty(workingDirectory)) runCommand = "cd " + quoteForShell(workingDirectory) + " && " + quoteForShell(getAbsolutePath(getExecutionCommand()));
+	else runCommand = getExecutionCommand();
+
+	system(runCommand.c_str());
+
+}
+
+void ObjectiveFunction::readOutputDesignFromDirectory(Design &d, std::string workingDirectory) const{
+
+	assert(isNotEmpty(definition.outputFilename));
+
+	std::string filename = definition.outputFilename;
+
+	if(isNotEmpty(workingDirectory)) filename = workingDirectory + "/" + definition.outputFilename;
+
+	rowvec outputs = readOutputFromFile(filename, getNumberOfOutputValues());
+	assignAndCacheOutputs(d, outputs);
+
+}
+
+/* sends the design vector (and the tangent direction) to the worker of the slot, which is started at the first call */
+
+rowvec ObjectiveFunction::callWorker(const Design &d, unsigned int slot) const{
+
+	assert(definition.ifWorkerMode);
+	assert(isNotEmpty(definition.executableName));
+	assert(slot < workers.size());
+
+	SimulationWorker &worker = *workers[slot];
+
+	if(!worker.isRunning()){
+
+		if(!worker.start(getExecutionCommand())){
+			abortWithErrorMessage("The worker process could not be started!\n");
+		}
+	}
+
+	std::vector<double> input(d.designParameters.begin(), d.designParameters.end());
+
+	if(evaluationMode.compare("tangent") == 0){
+
+		assert(d.tangentDirection.size() == dim);
+		input.insert(input.end(), d.tangentDirection.begin(), d.tangentDirection.end());
+	}
+
+	std::vector<double> result;
+
+	if(!worker.evaluate(input, result)){
+		abortWithErrorMessage("The communication with the worker process has failed!\n");
+	}
+
+	if(result.size() < getNumberOfOutputValues()){
+		abortWithErrorMessage("The worker has returned less values than expected!\n");
+	}
+
+	return rowvec(result);
+
+}
+
+void ObjectiveFunction::stopWorkers(void){
+
+	for(auto it = workers.begin(); it != workers.end(); it++){
+
+		(*it)->stop();
+	}
+}
+
 void ObjectiveFunction::evaluateObjectiveFunction(void){
 
 	assert(isNotEmpty(definition.executableName));
@@ -606,6 +964,18 @@ double ObjectiveFunction::interpolate(rowvec x) const{
 	return surrogate->interpolate(x);
 }
 
+/** Estimates and standard deviations for all rows of X with a single call to the surrogate model
+ *
+ */
+
+void ObjectiveFunction::interpolateBatchWithVariance(const mat &X, vec &estimates, vec &sigmas) const{
+
+	vec variances;
+	surrogate->interpolateBatch(X, estimates, &variances);
+
+	sigmas = sqrt(variances);
+}
+
 pair<double, double> ObjectiveFunction::interpolateWithVariance(rowvec x) const{
 
 	double ftilde,sigmaSqr;
@@ -618,6 +988,28 @@ pair<double, double> ObjectiveFunction::interpolateWithVariance(rowvec x) const{
 	return result;
 }
 
+/* returns the estimate and the standard deviation together with their gradients */
+
+void ObjectiveFunction::interpolateWithGradients(rowvec x, double *ftilde, double *sigma, rowvec &gradientEstimate, rowvec &gradientSigma) const{
+
+	double sigmaSqr;
+	rowvec gradientVariance;
+
+	surrogate->interpolateWithGradients(x, ftilde, &sigmaSqr, gradientEstimate, gradientVariance);
+
+	*sigma = sqrt(sigmaSqr);
+
+	if(*sigma > EPSILON){
+
+		gradientSigma = gradientVariance/(2.0*(*sigma));
+	}
+	else{
+
+		gradientSigma = zeros<rowvec>(x.size());
+	}
+
+}
+
 
 void ObjectiveFunction::print(void) const{
 	definition.print();
@@ -35,6 +35,14 @@
 #include <iostream>
 #include <unistd.h>
 #include <cassert>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <set>
+#include <omp.h>
 #include "auxiliary_functions.hpp"
 #include "kriging_training.hpp"
 #include "aggregation_model.hpp"
@@ -271,6 +279,44 @@ void Optimizer::setHowOftenZoomIn(unsigned int value){
 	howOftenZoomIn = value;
 }
 
+void Optimizer::setNumberOfJobSlots(unsigned int value){
+	assert(value > 0);
+	numberOfJobSlots = value;
+}
+
+/* the sandbox is shared with the objective function and the constraints, should be set after they are added */
+
+void Optimizer::setEvaluationSandbox(std::shared_ptr<EvaluationSandbox> sandboxToUse){
+
+	sandbox = sandboxToUse;
+
+	objFun.setEvaluationSandbox(sandbox);
+
+	for (auto it = constraintFunctions.begin(); it != constraintFunctions.end(); it++){
+
+		it->setEvaluationSandbox(sandbox);
+	}
+}
+
+/* the cache is shared with the objective function and the constraints, should be set after they are added */
+
+void Optimizer::setEvaluationCache(std::shared_ptr<EvaluationCache> cacheToUse){
+
+	objFun.setEvaluationCache(cacheToUse);
+
+	for (auto it = constraintFunctions.begin(); it != constraintFunctions.end(); it++){
+
+		it->setEvaluationCache(cacheToUse);
+	}
+}
+
+void Optimizer::setConstantLiarOn(void){
+	ifConstantLiarIsUsed = true;
+}
+void Optimizer::setConstantLiarOff(void){
+	ifConstantLiarIsUsed = false;
+}
+
 void Optimizer::addConstraint(ConstraintFunction &constFunc){
 
 	constraintFunctions.push_back(constFunc);
@@ -303,7 +349,7 @@ void Optimizer::evaluateConstraints(Design &d){
 		if(!it->checkIfGradientAvailable()){
 
 			it->setEvaluationMode("primal");
-			it->evaluateDesign(d);
+			it->setNumberOfJobSlots(1);
 
 		}else{
 
@@ -312,6 +358,159 @@ void Optimizer::evaluateConstraints(Design &d){
 		}
 
 	}
+
+	evaluateConstraintsOnJobSlot(d, 0, "", false);
+}
+
+/* sets the evaluation modes and the number of job slots of the objective function and the constraints */
+
+void Optimizer::prepareEvaluationsOnJobSlots(unsigned int howManySlots){
+
+	assert(howManySlots > 0);
+
+	if(!objFun.checkIfGradientAvailable()) objFun.setEvaluationMode("primal");
+	else objFun.setEvaluationMode("adjoint");
+
+	objFun.setNumberOfJobSlots(howManySlots);
+
+	for (auto it = constraintFunctions.begin(); it != constraintFunctions.end(); it++){
+
+		if(it->checkIfGradientAvailable()) abort();
+
+		it->setEvaluationMode("primal");
+		it->setNumberOfJobSlots(howManySlots);
+	}
+}
+
+/** Evaluates the constraints of a design. File-based constraints with the same executable are grouped, each
+ * executable runs only once and all constraints of the group read their outputs afterwards. If the objective function
+ * has been evaluated with the same executable in the same directory, its outputs are used without a new run.
+ * The groups (and the constraints in the worker mode) run concurrently, unless two of them write the same output file.
+ * Groups whose outputs are all found in the evaluation cache are not run.
+ *
+ * @param[in,out] d: design, the constraint values are written to d.constraintTrueValues
+ * @param[in] slot: job slot of the evaluation (worker mode)
+ * @param[in] workingDirectory: directory of the evaluation, empty for the current directory
+ * @param[in] ifObjectiveFunctionOutputIsAvailable: true if the objective function executable has run in the same directory
+ */
+
+void Optimizer::evaluateConstraintsOnJobSlot(Design &d, unsigned int slot, std::string workingDirectory, bool ifObjectiveFunctionOutputIsAvailable) const{
+
+	if(!ifConstrained()) return;
+
+	std::vector< std::vector<unsigned int> > groups;
+	std::map<std::string, unsigned int> groupOfExecutable;
+
+	for(unsigned int i=0; i<constraintFunctions.size(); i++){
+
+		const ConstraintFunction &constraint = constraintFunctions[i];
+
+		if(constraint.checkIfWorkerModeIsOn()){
+
+			groups.push_back(std::vector<unsigned int>(1,i));
+			continue;
+		}
+
+		std::string runCommand = constraint.getExecutionCommand();
+		auto it = groupOfExecutable.find(runCommand);
+
+		if(it == groupOfExecutable.end()){
+
+			groupOfExecutable[runCommand] = groups.size();
+			groups.push_back(std::vector<unsigned int>(1,i));
+		}
+		else{
+
+			groups[it->second].push_back(i);
+		}
+	}
+
+	unsigned int numberOfGroups = groups.size();
+
+	std::vector<bool> ifRunIsNecessary(numberOfGroups, true);
+	std::map<std::string, unsigned int> groupOfOutputFile;
+	bool ifGroupsCanRunConcurrently = true;
+
+	for(unsigned int g=0; g<numberOfGroups; g++){
+
+		const ConstraintFunction &firstConstraint = constraintFunctions[groups[g][0]];
+
+		/* if all constraints of the group are in the evaluation cache, the executable is not called */
+
+		bool ifAllOutputsAreCached = true;
+
+		for(auto it = groups[g].begin(); it != groups[g].end(); it++){
+
+			if(!constraintFunctions[*it].findOutputsInTheCache(d)) ifAllOutputsAreCached = false;
+		}
+
+		if(ifAllOutputsAreCached){
+
+			ifRunIsNecessary[g] = false;
+			continue;
+		}
+
+		if(firstConstraint.checkIfWorkerModeIsOn()) continue;
+
+		if(ifObjectiveFunctionOutputIsAvailable && !objFun.checkIfWorkerModeIsOn() &&
+				firstConstraint.getExecutionCommand() == objFun.getExecutionCommand()){
+
+			/* outputs of the objective function run are read before other executables start */
+
+			ifRunIsNecessary[g] = false;
+
+			for(auto it = groups[g].begin(); it != groups[g].end(); it++){
+
+				constraintFunctions[*it].readOutputDesignFromDirectory(d, workingDirectory);
+			}
+			continue;
+		}
+
+		/* constraints of a group share the executable but may read the design vector from different files */
+
+		std::set<std::string> writtenDesignVectorFiles;
+
+		for(auto it = groups[g].begin(); it != groups[g].end(); it++){
+
+			const ConstraintFunction &constraint = constraintFunctions[*it];
+
+			if(writtenDesignVectorFiles.insert(constraint.getFileNameDesignVector()).second){
+
+				constraint.writeDesignVariablesToDirectory(d, workingDirectory);
+			}
+		}
+
+		for(auto it = groups[g].begin(); it != groups[g].end(); it++){
+
+			std::string outputFile = constraintFunctions[*it].getFileNameOutput();
+			auto itOutput = groupOfOutputFile.find(outputFile);
+
+			if(itOutput == groupOfOutputFile.end()) groupOfOutputFile[outputFile] = g;
+			else if(itOutput->second != g) ifGroupsCanRunConcurrently = false;
+		}
+	}
+
+#pragma omp parallel for schedule(dynamic) num_threads(numberOfGroups) if(ifGroupsCanRunConcurrently && numberOfGroups > 1)
+	for(unsigned int g=0; g<numberOfGroups; g++){
+
+		if(!ifRunIsNecessary[g]) continue;
+
+		const ConstraintFunction &firstConstraint = constraintFunctions[groups[g][0]];
+
+		if(firstConstraint.checkIfWorkerModeIsOn()){
+
+			firstConstraint.evaluateDesignOnJobSlot(d, slot, workingDirectory);
+			continue;
+		}
+
+		firstConstraint.runExecutableInDirectory(workingDirectory);
+
+		for(auto it = groups[g].begin(); it != groups[g].end(); it++){
+
+			constraintFunctions[*it].readOutputDesignFromDirectory(d, workingDirectory);
+		}
+	}
+
 }
 
 void Optimizer::addConstraintValuesToDoEData(Design &d) const{
@@ -444,6 +643,13 @@ void Optimizer::print(void) const{
 	std::cout<<"Dimension    : "<<dimension<<"\n";
 	std::cout<<"Maximum number of function evaluations: " <<maxNumberOfSamples<<"\n";
 	std::cout<<"Maximum number of iterations for EI maximization: " <<iterMaxAcqusitionFunction <<"\n";
+	std::cout<<"Number of job slots: " <<numberOfJobSlots <<"\n";
+
+	if(numberOfJobSlots > 1){
+
+		if(ifConstantLiarIsUsed) std::cout<<"Pending designs: constant liar\n";
+		else std::cout<<"Pending designs: Kriging believer\n";
+	}
 
 
 	objFun.print();
@@ -588,6 +794,84 @@ void Optimizer::addPenaltyToAcqusitionFunctionForConstraints(DesignForBayesianOp
 }
 
 
+/** Same as addPenaltyToAcqusitionFunctionForConstraints, but also updates designCalculated.gradientAcqusitionFunction
+ * with the product rule, using dp/dx = +/- phi(z) dz/dx with z = (target - estimate)/sigma
+ *
+ */
+
+void Optimizer::addPenaltyToAcqusitionFunctionForConstraintsWithGradient(DesignForBayesianOptimization &designCalculated) const{
+
+	if(ifConstrained()){
+
+		assert(designCalculated.gradientAcqusitionFunction.size() == dimension);
+
+		rowvec x = designCalculated.dv;
+
+		rowvec probabilities(numberOfConstraints, fill::zeros);
+		mat gradientsOfProbabilities(numberOfConstraints, dimension, fill::zeros);
+
+		for (auto it = constraintFunctions.begin(); it != constraintFunctions.end(); it++){
+
+			int ID = it->getID();
+			string type  = it->getInequalityType();
+			double value = it->getInequalityTargetValue();
+
+			double estimated, sigma;
+			rowvec gradientEstimate, gradientSigma;
+
+			it->interpolateWithGradients(x, &estimated, &sigma, gradientEstimate, gradientSigma);
+
+			designCalculated.constraintValues(ID) = estimated;
+			designCalculated.constraintSigmas(ID) = sigma;
+
+			rowvec gradientZ(dimension, fill::zeros);
+			double pdfZ = 0.0;
+
+			if(sigma > EPSILON){
+
+				double z = (value - estimated)/sigma;
+				gradientZ = -(gradientEstimate + z*gradientSigma)/sigma;
+				pdfZ = pdf(z,0.0,1.0);
+			}
+
+			if(type.compare(">") == 0){
+
+				probabilities(ID) =  calculateProbalityGreaterThanAValue(value, estimated, sigma);
+				gradientsOfProbabilities.row(ID) = -pdfZ*gradientZ;
+			}
+
+			if(type.compare("<") == 0){
+
+				probabilities(ID) =  calculateProbalityLessThanAValue(value, estimated, sigma);
+				gradientsOfProbabilities.row(ID) = pdfZ*gradientZ;
+			}
+
+		}
+
+		designCalculated.constraintFeasibilityProbabilities = probabilities;
+
+		double acqusitionFunctionValue = designCalculated.valueAcqusitionFunction;
+		rowvec gradient = designCalculated.gradientAcqusitionFunction*prod(probabilities);
+
+		for(unsigned int i=0; i<numberOfConstraints; i++){
+
+			double productOfOtherProbabilities = 1.0;
+
+			for(unsigned int j=0; j<numberOfConstraints; j++){
+
+				if(j != i) productOfOtherProbabilities *= probabilities(j);
+			}
+
+			gradient += acqusitionFunctionValue*productOfOtherProbabilities*gradientsOfProbabilities.row(i);
+		}
+
+		designCalculated.gradientAcqusitionFunction = gradient;
+		designCalculated.updateAcqusitionFunctionAccordingToConstraints();
+
+	}
+}
+
+
 bool Optimizer::ifConstrained(void) const{
 
 	if(numberOfConstraints > 0) return true;
@@ -778,156 +1062,205 @@ void Optimizer::findTheGlobalOptimalDesignMultiFidelity(void){
 }
 
 
-/* These designs (there can be more than one) are found by maximizing the expected
- *  Improvement function and taking the constraints into account
+/** Evaluates iterMaxAcqusitionFunction random candidates within the box [lb, ub] in parallel and returns the one with the
+ * largest acqusition function value. The candidates are generated in blocks (one row for each candidate) and the
+ * surrogate models of the objective function and the constraints are evaluated for the whole block with interpolateBatch.
+ * Each thread keeps its own best candidate, these are reduced at the end. Ties are resolved by the candidate index and
+ * the candidates are generated from (seed, index), so the result does not depend on the number of threads
+ *
  */
-void Optimizer::findTheMostPromisingDesign(unsigned int howManyDesigns){
+DesignForBayesianOptimization Optimizer::findTheBestCandidateWithinBounds(const vec &lb, const vec &ub, unsigned long long seed) const{
 
-	assert(ifSurrogatesAreInitialized);
+	assert(lb.size() == dimension);
+	assert(ub.size() == dimension);
 
-	vec &lb = lowerBoundsForAcqusitionFunctionMaximization;
-	vec &ub = upperBoundsForAcqusitionFunctionMaximization;
+	unsigned int numberOfCandidates = iterMaxAcqusitionFunction;
+	const unsigned int blockSize = 256;
+	unsigned int numberOfBlocks = (numberOfCandidates + blockSize - 1)/blockSize;
 
-	theMostPromisingDesigns.clear();
+	DesignForBayesianOptimization bestDesign(dimension,numberOfConstraints);
+	bestDesign.dv = zeros<rowvec>(dimension);
 
+	bool ifCandidateIsFound = false;
+	unsigned int bestIndex = 0;
 
-	DesignForBayesianOptimization designWithMaxEI(dimension,numberOfConstraints);
+#pragma omp parallel
+	{
+		/* a single design object per thread, it is overwritten for each candidate */
+		DesignForBayesianOptimization designToBeTried(dimension,numberOfConstraints);
 
-#pragma omp parallel for
-	for(unsigned int i = 0; i <iterMaxAcqusitionFunction; i++ ){
+		DesignForBayesianOptimization bestDesignThread(dimension,numberOfConstraints);
+		bool ifCandidateIsFoundThread = false;
+		unsigned int bestIndexThread = 0;
 
+		mat candidates;
+		vec estimates, sigmas;
+		mat constraintEstimates, constraintSigmas;
 
-		DesignForBayesianOptimization designToBeTried(dimension,numberOfConstraints);
+#pragma omp for schedule(static)
+		for(unsigned int block=0; block<numberOfBlocks; block++){
 
+			unsigned int blockStart = block*blockSize;
+			unsigned int blockEnd = std::min(blockStart + blockSize, numberOfCandidates);
+			unsigned int numberOfCandidatesInBlock = blockEnd - blockStart;
 
+			candidates.set_size(numberOfCandidatesInBlock, dimension);
 
-		designToBeTried.generateRandomDesignVector(lb, ub);
+			for(unsigned int j=0; j<numberOfCandidatesInBlock; j++){
 
-		objFun.calculateExpectedImprovement(designToBeTried);
-		addPenaltyToAcqusitionFunctionForConstraints(designToBeTried);
+				unsigned long long i = blockStart + j;
 
-		//
-		//		if(designToBeTried.valueAcqusitionFunction>0){
-		//			designToBeTried.print();
-		//		}
+				for(unsigned int k=0; k<dimension; k++){
 
+					candidates(j,k) = generateRandomDoubleFromCounter(seed, i*dimension + k, lb(k), ub(k));
+				}
+			}
 
-		if(designToBeTried.valueAcqusitionFunction > designWithMaxEI.valueAcqusitionFunction){
+			objFun.interpolateBatchWithVariance(candidates, estimates, sigmas);
 
-			designWithMaxEI = designToBeTried;
-#if 0
-			printf("A design with a better EI value has been found\n");
-			designToBeTried.print();
-#endif
-		}
+			if(ifConstrained()){
 
-	}
+				constraintEstimates.set_size(numberOfCandidatesInBlock, numberOfConstraints);
+				constraintSigmas.set_size(numberOfCandidatesInBlock, numberOfConstraints);
 
-	//	designWithMaxEI.print();
+				for (auto it = constraintFunctions.begin(); it != constraintFunctions.end(); it++){
 
+					vec constraintEstimatesColumn, constraintSigmasColumn;
+					it->interpolateBatchWithVariance(candidates, constraintEstimatesColumn, constraintSigmasColumn);
 
+					constraintEstimates.col(it->getID()) = constraintEstimatesColumn;
+					constraintSigmas.col(it->getID()) = constraintSigmasColumn;
+				}
+			}
 
-#pragma omp parallel for
-	for(unsigned int i = 0; i < iterMaxAcqusitionFunction; i++ ){
+			for(unsigned int j=0; j<numberOfCandidatesInBlock; j++){
 
+				designToBeTried.dv = candidates.row(j);
+				designToBeTried.objectiveFunctionValue = estimates(j);
+				designToBeTried.sigma = sigmas(j);
+				designToBeTried.valueAcqusitionFunction = objFun.calculateExpectedImprovementValue(estimates(j), sigmas(j));
 
-		DesignForBayesianOptimization designToBeTried(dimension,numberOfConstraints);
+				if(ifConstrained()){
 
-		designToBeTried.generateRandomDesignVectorAroundASample(designWithMaxEI.dv, lb, ub);
+					designToBeTried.constraintValues = constraintEstimates.row(j);
+					designToBeTried.constraintSigmas = constraintSigmas.row(j);
 
-		objFun.calculateExpectedImprovement(designToBeTried);
-		addPenaltyToAcqusitionFunctionForConstraints(designToBeTried);
+					calculateFeasibilityProbabilities(designToBeTried);
+					designToBeTried.updateAcqusitionFunctionAccordingToConstraints();
+				}
 
-#if 0
-		designToBeTried.print();
-#endif
-		if(designToBeTried.valueAcqusitionFunction > designWithMaxEI.valueAcqusitionFunction){
+				if(!ifCandidateIsFoundThread || designToBeTried.valueAcqusitionFunction > bestDesignThread.valueAcqusitionFunction){
+
+					bestDesignThread = designToBeTried;
+					bestIndexThread = blockStart + j;
+					ifCandidateIsFoundThread = true;
+				}
+			}
 
-			designWithMaxEI = designToBeTried;
-#if 0
-			printf("A design with a better EI value has been found (second loop) \n");
-			designToBeTried.print();
-#endif
+		}
+
+#pragma omp critical
+		{
+			if(ifCandidateIsFoundThread){
+
+				bool ifBetter = !ifCandidateIsFound ||
+						bestDesignThread.valueAcqusitionFunction > bestDesign.valueAcqusitionFunction ||
+						(bestDesignThread.valueAcqusitionFunction == bestDesign.valueAcqusitionFunction && bestIndexThread < bestIndex);
+
+				if(ifBetter){
+
+					bestDesign = bestDesignThread;
+					bestIndex = bestIndexThread;
+					ifCandidateIsFound = true;
+				}
+			}
 		}
 
 	}
 
-	theMostPromisingDesigns.push_back(designWithMaxEI);
+	return bestDesign;
 
 }
 
 
-DesignForBayesianOptimization Optimizer::getDesignWithMaxExpectedImprovement(void) const{
-	return theMostPromisingDesigns.front();
-}
+/* These designs (there can be more than one) are found by maximizing the expected
+ *  Improvement function and taking the constraints into account
+ */
+void Optimizer::findTheMostPromisingDesign(unsigned int howManyDesigns){
 
+	assert(ifSurrogatesAreInitialized);
 
-rowvec Optimizer::calculateGradientOfAcqusitionFunction(DesignForBayesianOptimization &currentDesign) const{
+	vec &lb = lowerBoundsForAcqusitionFunctionMaximization;
+	vec &ub = upperBoundsForAcqusitionFunctionMaximization;
+
+	theMostPromisingDesigns.clear();
+
+	unsigned long long seed = generateRandomInt(0, RAND_MAX);
+
+	DesignForBayesianOptimization designWithMaxEI = findTheBestCandidateWithinBounds(lb, ub, seed);
 
+	/* second search in a small box around the best design */
 
-	rowvec gradient(dimension);
+	vec lbAroundTheBestDesign(dimension);
+	vec ubAroundTheBestDesign(dimension);
 
+	double dx = 0.01/dimension;
 
 	for(unsigned int i=0; i<dimension; i++){
-#if 0
-		printf("dv:\n");
-		dvGradientSearch.print();
-#endif
 
-		double dvSave = currentDesign.dv(i);
-#if 0
-		printf("epsilon_EI = %15.10f\n",epsilon_EI);
-#endif
+		lbAroundTheBestDesign(i) = std::max(designWithMaxEI.dv(i) - dx, lb(i));
+		ubAroundTheBestDesign(i) = std::min(designWithMaxEI.dv(i) + dx, ub(i));
+	}
+
+	DesignForBayesianOptimization designAroundTheBestDesign = findTheBestCandidateWithinBounds(lbAroundTheBestDesign, ubAroundTheBestDesign, seed + 1);
 
-		double epsilon = currentDesign.dv(i)*0.00001;
-		currentDesign.dv(i) += epsilon;
+	if(designAroundTheBestDesign.valueAcqusitionFunction > designWithMaxEI.valueAcqusitionFunction){
 
+		designWithMaxEI = designAroundTheBestDesign;
 #if 0
-		printf("dv perturbed:\n");
-		dvPerturbed.print();
+		printf("A design with a better EI value has been found (second loop) \n");
+		designWithMaxEI.print();
 #endif
+	}
 
-		objFun.calculateExpectedImprovement(currentDesign);
+	theMostPromisingDesigns.push_back(designWithMaxEI);
 
-		double EIplus = currentDesign.valueAcqusitionFunction;
-		currentDesign.dv(i) -= 2*epsilon;
+}
 
-		objFun.calculateExpectedImprovement(currentDesign);
 
-		double EIminus = currentDesign.valueAcqusitionFunction;
+DesignForBayesianOptimization Optimizer::getDesignWithMaxExpectedImprovement(void) const{
+	return theMostPromisingDesigns.front();
+}
 
 
-		/* obtain the forward finite difference quotient */
-		double fdVal = (EIplus - EIminus)/(2*epsilon);
-		gradient(i) = fdVal;
-		currentDesign.dv(i) = dvSave;
+/* evaluates the acqusition function (including the constraint penalty) and its analytic gradient at currentDesign */
 
+rowvec Optimizer::calculateGradientOfAcqusitionFunction(DesignForBayesianOptimization &currentDesign) const{
+
+	objFun.calculateExpectedImprovementWithGradient(currentDesign);
+	addPenaltyToAcqusitionFunctionForConstraintsWithGradient(currentDesign);
 
-	} /* end of finite difference loop */
 #if 0
 	printf("Gradient vector:\n");
-	gradEI.print();
+	currentDesign.gradientAcqusitionFunction.print();
 #endif
 
-	return gradient;
+	return currentDesign.gradientAcqusitionFunction;
 }
 
 
 
 DesignForBayesianOptimization Optimizer::MaximizeAcqusitionFunctionGradientBased(DesignForBayesianOptimization initialDesign) const {
 
-	rowvec gradEI(dimension);
 	double stepSize0 = 0.001;
 	double stepSize = 0.0;
 
+	DesignForBayesianOptimization bestDesign = initialDesign;
 
+	/* one evaluation gives both the value and the gradient */
+	rowvec gradEI = calculateGradientOfAcqusitionFunction(bestDesign);
 
-	objFun.calculateExpectedImprovement(initialDesign);
-	addPenaltyToAcqusitionFunctionForConstraints(initialDesign);
-
-
-	double EI0 = initialDesign.valueAcqusitionFunction;
-	DesignForBayesianOptimization bestDesign = initialDesign;
+	double EI0 = bestDesign.valueAcqusitionFunction;
 
 	bool breakOptimization = false;
 
@@ -937,9 +1270,6 @@ DesignForBayesianOptimization Optimizer::MaximizeAcqusitionFunctionGradientBased
 		printf("\nGradient search iteration = %d\n", iterGradientSearch);
 #endif
 
-
-		gradEI = calculateGradientOfAcqusitionFunction(bestDesign);
-
 		/* save the design vector */
 		DesignForBayesianOptimization dvLineSearchSave = bestDesign ;
 
@@ -998,6 +1328,8 @@ DesignForBayesianOptimization Optimizer::MaximizeAcqusitionFunctionGradientBased
 
 		if(breakOptimization) break;
 
+		gradEI = calculateGradientOfAcqusitionFunction(bestDesign);
+
 	} /* end of gradient-search loop */
 
 
@@ -1199,6 +1531,35 @@ mat Optimizer::getOptimizationHistory(void) const{
 }
 
 
+/* maximizes the acquisition function and returns the resulting design vector (not normalized) */
+
+rowvec Optimizer::findTheNextDesignToEvaluate(void){
+
+	findTheMostPromisingDesign();
+
+	DesignForBayesianOptimization optimizedDesignGradientBased = MaximizeAcqusitionFunctionGradientBased(theMostPromisingDesigns.at(0));
+
+#if 0
+	optimizedDesignGradientBased.print();
+#endif
+
+
+	rowvec best_dvNorm = optimizedDesignGradientBased.dv;
+	rowvec best_dv =normalizeRowVectorBack(best_dvNorm, lowerBounds, upperBounds);
+
+#if 0
+	double estimatedBestdv = objFun.interpolate(best_dvNorm);
+	printf("The most promising design (not normalized):\n");
+	best_dv.print();
+	std::cout<<"Estimated objective function value = "<<estimatedBestdv<<"\n";
+#endif
+
+
+	roundDiscreteParameters(best_dv);
+
+	return best_dv;
+}
+
 void Optimizer::EfficientGlobalOptimization(void){
 
 	assert(ifObjectFunctionIsSpecied);
@@ -1217,6 +1578,19 @@ void Optimizer::EfficientGlobalOptimization(void){
 		isHistoryFileInitialized = true;
 	}
 
+	if(numberOfJobSlots > 1){
+
+		if(objFun.checkIfPendingDesignsAreSupported()){
+
+			EfficientGlobalOptimizationAsynchronous();
+			return;
+		}
+
+		output.printMessage("Pending designs are supported only by the Kriging model, the optimization runs with a single job slot...");
+	}
+
+	prepareEvaluationsOnJobSlots(1);
+
 	/* main loop for optimization */
 	unsigned int simulationCount = 0;
 	unsigned int iterOpt=0;
@@ -1242,27 +1616,7 @@ void Optimizer::EfficientGlobalOptimization(void){
 
 		}
 
-		findTheMostPromisingDesign();
-
-		DesignForBayesianOptimization optimizedDesignGradientBased = MaximizeAcqusitionFunctionGradientBased(theMostPromisingDesigns.at(0));
-
-#if 0
-		optimizedDesignGradientBased.print();
-#endif
-
-
-		rowvec best_dvNorm = optimizedDesignGradientBased.dv;
-		rowvec best_dv =normalizeRowVectorBack(best_dvNorm, lowerBounds, upperBounds);
-		double estimatedBestdv = objFun.interpolate(best_dvNorm);
-
-#if 0
-		printf("The most promising design (not normalized):\n");
-		best_dv.print();
-		std::cout<<"Estimated objective function value = "<<estimatedBestdv<<"\n";
-#endif
-
-
-		roundDiscreteParameters(best_dv);
+		rowvec best_dv = findTheNextDesignToEvaluate();
 
 		Design currentBestDesign(best_dv);
 		currentBestDesign.tag = "Current best design";
@@ -1273,40 +1627,13 @@ void Optimizer::EfficientGlobalOptimization(void){
 
 		/* now make a simulation for the most promising design */
 
-		if(!objFun.checkIfGradientAvailable()) {
-
-			objFun.setEvaluationMode("primal");
-			objFun.evaluateDesign(currentBestDesign);
-			objFun.addDesignToData(currentBestDesign);
-
+		evaluateDesignOnJobSlot(currentBestDesign, 0);
 
-		}
-		else{
-
-			objFun.setEvaluationMode("adjoint");
-			objFun.evaluateDesign(currentBestDesign);
-			objFun.addDesignToData(currentBestDesign);
-
-		}
-
-
-		computeConstraintsandPenaltyTerm(currentBestDesign);
-
-
-
-		calculateImprovementValue(currentBestDesign);
-
-		if(currentBestDesign.checkIfHasNan()){
-			abortWithErrorMessage("NaN while reading external executable outputs");
-		}
 #if 0
 		currentBestDesign.print();
 #endif
 
-		addConstraintValuesToData(currentBestDesign);
-		updateOptimizationHistory(currentBestDesign);
-
-		findTheGlobalOptimalDesign();
+		addEvaluatedDesignToTheStudy(currentBestDesign);
 
 		if(ifDisplay){
 
@@ -1345,6 +1672,253 @@ void Optimizer::EfficientGlobalOptimization(void){
 
 }
 
+/** Asynchronous version of the EGO loop with numberOfJobSlots simulations running at the same time.
+ * Whenever a job slot is free, a new design is proposed while the designs that are still being evaluated
+ * are added to the Kriging model as pending designs (Kriging believer or constant liar), so that the
+ * proposals do not cluster around the same point. The results are added to the study as soon as they finish.
+ *
+ */
+
+void Optimizer::EfficientGlobalOptimizationAsynchronous(void){
+
+	assert(numberOfJobSlots > 1);
+	assert(objFun.checkIfPendingDesignsAreSupported());
+
+	output.printMessage("Asynchronous optimization, number of job slots = ", int(numberOfJobSlots));
+
+	prepareEvaluationsOnJobSlots(numberOfJobSlots);
+
+	/* without a sandbox, the file-based evaluations of each job slot run in a directory of the slot, so that they do not overlap in the current directory */
+
+	ifJobSlotDirectoriesAreUsed = !sandbox && checkIfFileBasedEvaluationsExist();
+
+	if(ifJobSlotDirectoriesAreUsed){
+
+		output.printMessage("No sandbox is set, the simulations of the job slots run in the directory:", this->name + "_JobSlots");
+
+		removeDirectory(this->name + "_JobSlots");
+
+		if(!createDirectory(this->name + "_JobSlots")){
+			abortWithErrorMessage("Cannot create the directory: " + this->name + "_JobSlots");
+		}
+
+		for(unsigned int slot=0; slot<numberOfJobSlots; slot++){
+
+			if(!createDirectory(getDirectoryJobSlot(slot))){
+				abortWithErrorMessage("Cannot create the directory: " + getDirectoryJobSlot(slot));
+			}
+		}
+	}
+
+	std::vector<Design> designsOnJobSlots(numberOfJobSlots);
+	std::vector<std::thread> threadsOnJobSlots(numberOfJobSlots);
+	std::vector<bool> ifJobSlotIsBusy(numberOfJobSlots, false);
+
+	std::deque<unsigned int> finishedJobSlots;
+	std::mutex mutexFinishedJobSlots;
+	std::condition_variable conditionJobIsFinished;
+
+	unsigned int simulationCount = 0;
+	unsigned int numberOfDispatchedSimulations = 0;
+	unsigned int numberOfRunningSimulations = 0;
+	unsigned int simulationCountForTheNextTraining = 0;
+	unsigned int iterOpt=0;
+
+	while(1){
+
+		/* fill the free job slots */
+
+		for(unsigned int slot=0; slot<numberOfJobSlots; slot++){
+
+			if(ifJobSlotIsBusy[slot] || numberOfDispatchedSimulations >= maxNumberOfSamples) continue;
+
+			iterOpt++;
+
+			output.printMessage("############################################");
+			output.printMessage("Iteration = ",iterOpt);
+
+			if(simulationCount >= simulationCountForTheNextTraining) {
+
+				trainSurrogates();
+				simulationCountForTheNextTraining = simulationCount + howOftenTrainModels;
+			}
+
+			if(iterOpt%howOftenZoomIn == 0){
+
+				if(ifZoomInDesignSpaceIsAllowed) zoomInDesignSpace();
+
+			}
+
+			for(unsigned int i=0; i<numberOfJobSlots; i++){
+
+				if(ifJobSlotIsBusy[i]){
+
+					rowvec xNormalized = normalizeRowVector(designsOnJobSlots[i].designParameters, lowerBounds, upperBounds);
+					objFun.addPendingDesign(xNormalized, ifConstantLiarIsUsed);
+				}
+			}
+
+			rowvec best_dv = findTheNextDesignToEvaluate();
+
+			objFun.removePendingDesigns();
+
+			Design &d = designsOnJobSlots[slot];
+
+			d = Design(best_dv);
+			d.tag = "Current best design";
+			d.setNumberOfConstraints(numberOfConstraints);
+			d.isDesignFeasible = true;
+
+			ifJobSlotIsBusy[slot] = true;
+			numberOfDispatchedSimulations++;
+			numberOfRunningSimulations++;
+
+			output.printMessage("Dispatching a new design to the job slot", int(slot));
+
+			threadsOnJobSlots[slot] = std::thread([this, &d, slot, &finishedJobSlots, &mutexFinishedJobSlots, &conditionJobIsFinished](){
+
+				evaluateDesignOnJobSlot(d, slot);
+
+				std::lock_guard<std::mutex> lock(mutexFinishedJobSlots);
+				finishedJobSlots.push_back(slot);
+				conditionJobIsFinished.notify_one();
+			});
+
+		}
+
+		if(numberOfRunningSimulations == 0) break;
+
+		/* wait for the first simulation that finishes */
+
+		unsigned int finishedSlot;
+		{
+			std::unique_lock<std::mutex> lock(mutexFinishedJobSlots);
+			conditionJobIsFinished.wait(lock, [&finishedJobSlots]{ return !finishedJobSlots.empty(); });
+
+			finishedSlot = finishedJobSlots.front();
+			finishedJobSlots.pop_front();
+		}
+
+		threadsOnJobSlots[finishedSlot].join();
+		ifJobSlotIsBusy[finishedSlot] = false;
+		numberOfRunningSimulations--;
+
+		Design &currentBestDesign = designsOnJobSlots[finishedSlot];
+
+		addEvaluatedDesignToTheStudy(currentBestDesign);
+
+		if(ifDisplay){
+
+			std::cout<<"##########################################\n";
+			std::cout<<"Simulation = "<<simulationCount+1<<" (job slot "<<finishedSlot<<")\n";
+			currentBestDesign.print();
+			std::cout<<"\n\n";
+
+		}
+
+		simulationCount++;
+
+	} /* end of the optimization loop */
+
+	if(ifJobSlotDirectoriesAreUsed){
+
+		removeDirectory(this->name + "_JobSlots");
+		ifJobSlotDirectoriesAreUsed = false;
+	}
+
+	if(ifDisplay){
+
+		printf("number of simulations > max_number_of_samples! Optimization is terminating...\n");
+
+		std::cout<<"##########################################\n";
+		std::cout<<"Global best design = \n";
+		globalOptimalDesign.print();
+		std::cout<<"\n\n";
+
+	}
+
+	if(ifVisualize){
+
+		visualizeOptimizationHistory();
+	}
+
+}
+
+/* runs the objective function and the constraints for a design, called from the thread of the job slot.
+ * With a sandbox all executables of the design run in the same job directory, in the asynchronous loop without
+ * a sandbox they run in the directory of the slot. Otherwise the file-based evaluations of different designs share
+ * the current directory and must not overlap */
+
+void Optimizer::evaluateDesignOnJobSlot(Design &d, unsigned int slot) const{
+
+	static std::mutex mutexCurrentDirectory;
+
+	std::string workingDirectory;
+
+	if(sandbox) workingDirectory = sandbox->createJobDirectory("design");
+	else if(ifJobSlotDirectoriesAreUsed) workingDirectory = getDirectoryJobSlot(slot);
+
+	std::unique_lock<std::mutex> lock(mutexCurrentDirectory, std::defer_lock);
+
+	if(workingDirectory.empty() && checkIfFileBasedEvaluationsExist()) lock.lock();
+
+	bool ifObjectiveRun = objFun.evaluateDesignOnJobSlot(d, slot, workingDirectory);
+
+	evaluateConstraintsOnJobSlot(d, slot, workingDirectory, ifObjectiveRun);
+
+	if(lock.owns_lock()) lock.unlock();
+
+	if(sandbox) sandbox->finalizeJobDirectory(workingDirectory);
+
+}
+
+std::string Optimizer::getDirectoryJobSlot(unsigned int slot) const{
+
+	return this->name + "_JobSlots/slot" + std::to_string(slot);
+}
+
+bool Optimizer::checkIfFileBasedEvaluationsExist(void) const{
+
+	if(!objFun.checkIfWorkerModeIsOn()) return true;
+
+	for (auto it = constraintFunctions.begin(); it != constraintFunctions.end(); it++){
+
+		if(!it->checkIfWorkerModeIsOn()) return true;
+	}
+
+	return false;
+}
+
+/* adds a design evaluated on a job slot to the surrogate models and to the optimization history */
+
+void Optimizer::addEvaluatedDesignToTheStudy(Design &d){
+
+	objFun.addDesignToData(d);
+
+	if(ifConstrained()){
+
+		bool ifConstraintsSatisfied = checkConstraintFeasibility(d.constraintTrueValues);
+		if(!ifConstraintsSatisfied){
+
+			output.printMessage("The new sample does not satisfy all the constraints");
+			d.isDesignFeasible = false;
+
+		}
+	}
+
+	calculateImprovementValue(d);
+
+	if(d.checkIfHasNan()){
+		abortWithErrorMessage("NaN while reading external executable outputs");
+	}
+
+	addConstraintValuesToData(d);
+	updateOptimizationHistory(d);
+
+	findTheGlobalOptimalDesign();
+
+}
+
 
 //void Optimizer::EfficientGlobalOptimization2(void){
 //
@@ -1627,6 +2201,15 @@ void Optimizer::calculateImprovementValue(Design &d){
 
 
 
+/** Evaluates the DoE samples with up to numberOfJobSlots simulations at the same time. Every sample is evaluated in its own
+ * directory under "<name>_DoE" (filled from the template directory of the sandbox, if set). The results of a sample are saved in its directory as soon as it is evaluated,
+ * so that an interrupted DoE continues with the remaining samples when it is started again with the same settings.
+ * The training data files are written in the order of the samples, after all samples are evaluated.
+ *
+ * @param[in] howManySamples: number of DoE samples
+ * @param[in] methodID: only LHS is supported
+ */
+
 void Optimizer::performDoE(unsigned int howManySamples, DoE_METHOD methodID){
 
 	if(ifDisplay){
@@ -1652,12 +2235,35 @@ void Optimizer::performDoE(unsigned int howManySamples, DoE_METHOD methodID){
 
 	}
 
+	if(methodID != LHS){
+
+		cout<<"ERROR: Cannot run DoE with any option other than LHS!\n";
+		abort();
+	}
 
+	std::string directoryDoE = this->name + "_DoE";
+	std::string filenameSamplesDoE = directoryDoE + "/samples.csv";
 
 	mat sampleCoordinates;
 
+	/* samples of an interrupted DoE are reused */
+
+	if(directory_exist(directoryDoE) && file_exist(filenameSamplesDoE)){
 
-	if(methodID == LHS){
+		sampleCoordinates.load(filenameSamplesDoE, csv_ascii);
+	}
+
+	if(sampleCoordinates.n_rows == howManySamples && sampleCoordinates.n_cols == dimension){
+
+		output.printMessage("Continuing the DoE in the directory:", directoryDoE);
+	}
+	else{
+
+		removeDirectory(directoryDoE);
+
+		if(!createDirectory(directoryDoE)){
+			abortWithErrorMessage("Cannot create the DoE directory: " + directoryDoE);
+		}
 
 		LHSSamples DoE(dimension, lowerBounds, upperBounds, howManySamples);
 
@@ -1669,81 +2275,80 @@ void Optimizer::performDoE(unsigned int howManySamples, DoE_METHOD methodID){
 
 		}
 
-
-		std::string filename= this->name + "_samples.csv";
-		DoE.saveSamplesToCSVFile(filename);
 		sampleCoordinates = DoE.getSamples();
+		sampleCoordinates.save(filenameSamplesDoE, csv_ascii);
 	}
-	else{
-
-		cout<<"ERROR: Cannot run DoE with any option other than LHS!\n";
-		abort();
 
-	}
+	std::string filename= this->name + "_samples.csv";
+	sampleCoordinates.save(filename, csv_ascii);
 
 
 #if 0
 	printMatrix(sampleCoordinates,"sampleCoordinates");
 #endif
 
+	prepareEvaluationsOnJobSlots(numberOfJobSlots);
+
+	std::vector<unsigned int> samplesToEvaluate;
 
 	for(unsigned int sampleID=0; sampleID<howManySamples; sampleID++){
 
-		if(ifDisplay){
+		if(!file_exist(getFileNameDoEResult(sampleID))) samplesToEvaluate.push_back(sampleID);
+	}
 
-			std::cout<<"\n##########################################\n";
-			std::cout<<"Evaluating sample "<<sampleID<<"\n";
+	output.printMessage("Number of samples to be evaluated = ", int(samplesToEvaluate.size()));
 
+	unsigned int numberOfSamplesToEvaluate = samplesToEvaluate.size();
+
+#pragma omp parallel for schedule(dynamic) num_threads(numberOfJobSlots) if(numberOfJobSlots > 1)
+	for(unsigned int i=0; i<numberOfSamplesToEvaluate; i++){
+
+		unsigned int sampleID = samplesToEvaluate[i];
+
+		if(ifDisplay){
+#pragma omp critical
+			std::cout<<"Evaluating sample "<<sampleID<<"\n";
 		}
 
-		rowvec dv = sampleCoordinates.row(sampleID);
-		Design currentDesign(dv);
-		currentDesign.setNumberOfConstraints(numberOfConstraints);
-		currentDesign.saveDesignVector(designVectorFileName);
+		evaluateDoESample(sampleCoordinates.row(sampleID), sampleID, omp_get_thread_num());
+
+	}
+
+	/* training data is written in the order of the samples */
+
+	for(unsigned int sampleID=0; sampleID<howManySamples; sampleID++){
 
+		Design currentDesign = readDoESample(sampleCoordinates.row(sampleID), sampleID);
 
 		std::string filenameCVS = objFun.getName()+".csv";
 
 		if(ifDisplay){
 
+			std::cout<<"\n##########################################\n";
+			std::cout<<"Sample "<<sampleID<<"\n";
 			std::cout<<"Appending to data: "<<filenameCVS<<"\n";
 
 		}
 
 		if(!objFun.checkIfGradientAvailable()) {
 
-			//CEO			objFun.evaluate(currentDesign);
-			//CEO			objFun.readEvaluateOutput(currentDesign);
-			rowvec temp(dimension+1);
-			copyRowVector(temp,dv);
-			temp(dimension) = currentDesign.trueValue;
-			appendRowVectorToCSVData(temp,filenameCVS);
-
-
+			appendRowVectorToCSVData(currentDesign.constructSampleObjectiveFunction(),filenameCVS);
 		}
 		else{
 
-			//CEO			objFun.evaluateAdjoint(currentDesign);
-			//CEO			objFun.readEvaluateOutput(currentDesign);
-			rowvec temp(2*dimension+1);
-			copyRowVector(temp,currentDesign.designParameters);
-			temp(dimension) = currentDesign.trueValue;
-			copyRowVector(temp,currentDesign.gradient, dimension+1);
-
+			appendRowVectorToCSVData(currentDesign.constructSampleObjectiveFunctionWithGradient(),filenameCVS);
+		}
 
-			appendRowVectorToCSVData(temp,filenameCVS);
+		currentDesign.isDesignFeasible = true;
 
+		if(ifConstrained()){
 
-		}
+			if(!checkConstraintFeasibility(currentDesign.constraintTrueValues)){
 
-		if(ifConstrained()){
-			computeConstraintsandPenaltyTerm(currentDesign);
-		}
-		else{
-			currentDesign.isDesignFeasible = true;
+				currentDesign.isDesignFeasible = false;
+			}
 		}
 
-
 		calculateImprovementValue(currentDesign);
 
 		addConstraintValuesToDoEData(currentDesign);
@@ -1753,9 +2358,79 @@ void Optimizer::performDoE(unsigned int howManySamples, DoE_METHOD methodID){
 
 	} /* end of sample loop */
 
+	if(sandbox) sandbox->finalizeJobDirectory(directoryDoE);
+	else removeDirectory(directoryDoE);
+
+}
+
+std::string Optimizer::getFileNameDoEResult(unsigned int sampleID) const{
+
+	return this->name + "_DoE/sample" + std::to_string(sampleID) + "/result.csv";
+}
+
+/* evaluates a single DoE sample in its own directory and saves the objective function and the constraint values,
+ * can be called concurrently for different samples */
+
+void Optimizer::evaluateDoESample(rowvec dv, unsigned int sampleID, unsigned int slot) const{
+
+	std::string directorySample = this->name + "_DoE/sample" + std::to_string(sampleID);
+
+	if(!createDirectory(directorySample)){
+		abortWithErrorMessage("Cannot create the directory: " + directorySample);
+	}
+
+	if(sandbox) sandbox->copyTemplateToDirectory(directorySample);
+
+	Design currentDesign(dv);
+	currentDesign.setNumberOfConstraints(numberOfConstraints);
+
+	bool ifObjectiveRun = objFun.evaluateDesignOnJobSlot(currentDesign, slot, directorySample);
+
+	evaluateConstraintsOnJobSlot(currentDesign, slot, directorySample, ifObjectiveRun);
+
+	if(currentDesign.checkIfHasNan()){
+		abortWithErrorMessage("NaN while reading external executable outputs");
+	}
+
+	/* result: objective function value, gradient (if available), constraint values */
+
+	rowvec result(1);
+	result(0) = currentDesign.trueValue;
+
+	if(objFun.checkIfGradientAvailable()) result = join_rows(result, currentDesign.gradient);
+	if(numberOfConstraints > 0)           result = join_rows(result, currentDesign.constraintTrueValues);
+
+	/* the result file is renamed at the end, so that it exists only if it is written completely */
+
+	std::string filenameResult = getFileNameDoEResult(sampleID);
+	std::string filenameTemporary = filenameResult + ".tmp";
+
+	result.save(filenameTemporary, csv_ascii);
+	rename(filenameTemporary.c_str(), filenameResult.c_str());
+
+}
+
+Design Optimizer::readDoESample(rowvec dv, unsigned int sampleID) const{
+
+	Design currentDesign(dv);
+	currentDesign.setNumberOfConstraints(numberOfConstraints);
+
+	rowvec result;
+	result.load(getFileNameDoEResult(sampleID), csv_ascii);
+
+	unsigned int sizeGradient = 0;
+	if(objFun.checkIfGradientAvailable()) sizeGradient = dimension;
+
+	if(result.size() != 1 + sizeGradient + numberOfConstraints){
+		abortWithErrorMessage("The DoE result file does not match the problem settings: " + getFileNameDoEResult(sampleID));
+	}
 
+	currentDesign.trueValue = result(0);
 
+	if(sizeGradient > 0) currentDesign.gradient = result.subvec(1, dimension);
+	if(numberOfConstraints > 0) currentDesign.constraintTrueValues = result.tail(numberOfConstraints);
 
+	return currentDesign;
 }
 
 void Optimizer::displayMessage(std::string inputString) const{
@@ -30,6 +30,9 @@
  */
 
 #include <cassert>
+#include <atomic>
+#include <random>
+#include <omp.h>
 
 #include "random_functions.hpp"
 #include "auxiliary_functions.hpp"
@@ -39,9 +42,199 @@
 
 using namespace arma;
 
+
+/* xoshiro256** generator, each thread uses its own stream. The streams are obtained from the global seed by jump(),
+ * which advances the state by 2^128 steps, so that the streams never overlap */
+
+class RandomNumberGenerator{
+
+private:
+
+	unsigned long long state[4];
+
+	static unsigned long long rotateLeft(unsigned long long x, int k){
+
+		return (x << k) | (x >> (64 - k));
+	}
+
+public:
+
+	typedef unsigned long long result_type;
+
+	static constexpr result_type min(void) { return 0; }
+	static constexpr result_type max(void) { return ~0ULL; }
+
+	void seed(unsigned long long seedValue){
+
+		/* the state is filled by splitmix64, so that any seed (also 0) gives a valid state */
+		for(unsigned int i=0; i<4; i++){
+
+			seedValue += 0x9E3779B97F4A7C15ULL;
+			unsigned long long z = seedValue;
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+			state[i] = z ^ (z >> 31);
+		}
+	}
+
+	result_type operator()(void){
+
+		unsigned long long result = rotateLeft(state[1] * 5, 7) * 9;
+		unsigned long long t = state[1] << 17;
+
+		state[2] ^= state[0];
+		state[3] ^= state[1];
+		state[1] ^= state[2];
+		state[0] ^= state[3];
+		state[2] ^= t;
+		state[3] = rotateLeft(state[3], 45);
+
+		return result;
+	}
+
+	void jump(void){
+
+		static const unsigned long long JUMP[] = { 0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL };
+
+		unsigned long long newState[4] = {0, 0, 0, 0};
+
+		for(unsigned int i=0; i<4; i++){
+			for(unsigned int b=0; b<64; b++){
+
+				if (JUMP[i] & (1ULL << b)){
+
+					for(unsigned int j=0; j<4; j++) newState[j] ^= state[j];
+				}
+				(*this)();
+			}
+		}
+
+		for(unsigned int j=0; j<4; j++) state[j] = newState[j];
+	}
+
+	/* advances the state by 2^192 steps */
+	void longJump(void){
+
+		static const unsigned long long LONG_JUMP[] = { 0x76e15d3efefdcbbfULL, 0xc5004e441c522fb3ULL, 0x77710069854ee241ULL, 0x39109bb02acbe635ULL };
+
+		unsigned long long newState[4] = {0, 0, 0, 0};
+
+		for(unsigned int i=0; i<4; i++){
+			for(unsigned int b=0; b<64; b++){
+
+				if (LONG_JUMP[i] & (1ULL << b)){
+
+					for(unsigned int j=0; j<4; j++) newState[j] ^= state[j];
+				}
+				(*this)();
+			}
+		}
+
+		for(unsigned int j=0; j<4; j++) state[j] = newState[j];
+	}
+
+	/* 53 random bits mapped to [0,1) */
+	double generateUniform(void){
+
+		return ((*this)() >> 11) * (1.0/9007199254740992.0);
+	}
+
+};
+
+
+static std::atomic<unsigned long long> globalRandomSeed(1);
+static std::atomic<unsigned int> globalRandomSeedVersion(0);
+static std::atomic<unsigned int> numberOfRandomStreamsOutsideOpenMP(0);
+
+struct ThreadRandomNumberGenerator{
+
+	RandomNumberGenerator generator;
+	unsigned int seedVersion = ~0U;
+};
+
+static thread_local ThreadRandomNumberGenerator threadRandomNumberGenerator;
+
+static void initializeThreadRandomNumberGenerator(unsigned int stream, bool ifThreadIsOutsideOpenMP = false){
+
+	ThreadRandomNumberGenerator &threadGenerator = threadRandomNumberGenerator;
+
+	threadGenerator.generator.seed(globalRandomSeed.load());
+
+	/* streams of the threads that are not started by OpenMP are far away from the OpenMP streams */
+	if(ifThreadIsOutsideOpenMP){
+
+		threadGenerator.generator.longJump();
+	}
+
+	for(unsigned int i=0; i<stream; i++){
+
+		threadGenerator.generator.jump();
+	}
+
+	threadGenerator.seedVersion = globalRandomSeedVersion.load();
+}
+
+/* returns the generator of the calling thread, a thread gets its stream at its first call after the seed is set.
+ * Within a parallel region the stream is the OpenMP thread number, so it does not depend on the order of the calls */
+static RandomNumberGenerator &getRandomNumberGenerator(void){
+
+	ThreadRandomNumberGenerator &threadGenerator = threadRandomNumberGenerator;
+
+	if(threadGenerator.seedVersion != globalRandomSeedVersion.load(std::memory_order_relaxed)){
+
+		if(omp_in_parallel()){
+
+			initializeThreadRandomNumberGenerator(omp_get_thread_num());
+		}
+		else{
+
+			initializeThreadRandomNumberGenerator(numberOfRandomStreamsOutsideOpenMP++, true);
+		}
+	}
+
+	return threadGenerator.generator;
+}
+
+/* x[i] = lb[i] + (ub[i] - lb[i]) * u, u uniform in [0,1) */
+static void fillWithRandomNumbers(double *x, const double *lb, const double *ub, unsigned int n){
+
+	RandomNumberGenerator &generator = getRandomNumberGenerator();
+
+	for(unsigned int i=0; i<n; i++) {
+
+		assert(lb[i] <= ub[i]);
+		x[i] = lb[i] + (ub[i] - lb[i])*generator.generateUniform();
+	}
+}
+
+
+/** Sets the seed of all random numbers (also the Armadillo generator). The calling thread gets the first stream, so that
+ * serial runs are reproducible. OpenMP thread i uses the stream i, i.e. the seeded state advanced by i jumps.
+ * For results that do not depend on the number of threads use generateRandomDoubleFromCounter
+ *
+ */
+void setRandomSeed(unsigned long long seed){
+
+	globalRandomSeed = seed;
+	numberOfRandomStreamsOutsideOpenMP = 0;
+	globalRandomSeedVersion++;
+
+	initializeThreadRandomNumberGenerator(0);
+
+	arma_rng::set_seed(seed);
+}
+
+unsigned long long getRandomSeed(void){
+
+	return globalRandomSeed.load();
+}
+
+
 int generateRandomInt(int a, int b){
 	assert(b>a);
-	return(rand() % (b-a)+a);
+
+	RandomNumberGenerator &generator = getRandomNumberGenerator();
+	return(int(generator() % (unsigned long long)(b-a))+a);
 
 }
 
@@ -59,19 +252,21 @@ int generateRandomInt(uvec indices){
 
 double generateRandomDouble(double a, double b) {
 
+	RandomNumberGenerator &generator = getRandomNumberGenerator();
 
-	double random = ((double) rand()) / (double) RAND_MAX;
 	double diff = b - a;
-	double r = random * diff;
+	double r = generator.generateUniform() * diff;
 	return a + r;
 }
 
 
 void generateRandomDoubleArray(double *xp,double a, double b, unsigned int dim) {
 
+	RandomNumberGenerator &generator = getRandomNumberGenerator();
+
 	for(unsigned int i=0; i<dim; i++) {
 
-		xp[i] = generateRandomDouble(a,b);
+		xp[i] = a + (b - a)*generator.generateUniform();
 
 	}
 
@@ -80,13 +275,12 @@ void generateRandomDoubleArray(double *xp,double a, double b, unsigned int dim)
 
 
 
-rowvec generateRandomRowVector(vec lb, vec ub){
+rowvec generateRandomRowVector(const vec &lb, const vec &ub){
+
+	assert(lb.size() == ub.size());
 	unsigned int dim = lb.size();
 	rowvec x(dim);
-	for(unsigned int i=0; i<dim; i++) {
-		assert(lb(i) <= ub(i));
-		x(i) = generateRandomDouble(lb(i), ub(i));
-	}
+	fillWithRandomNumbers(x.memptr(), lb.memptr(), ub.memptr(), dim);
 	return x;
 
 }
@@ -94,38 +288,45 @@ rowvec generateRandomRowVector(vec lb, vec ub){
 rowvec generateRandomRowVector(double lb, double ub, unsigned int dim){
 
 	assert(lb <= ub);
-	rowvec x(dim,fill::zeros);
-
-	for(unsigned int i=0; i<dim; i++) {
-
-		x(i) = generateRandomDouble(lb, ub);
-	}
+	rowvec x(dim);
+	generateRandomDoubleArray(x.memptr(), lb, ub, dim);
 	return x;
 
 }
 
-vec generateRandomVector(vec lb, vec ub){
+vec generateRandomVector(const vec &lb, const vec &ub){
+
+	assert(lb.size() == ub.size());
 	unsigned int dim = lb.size();
 	vec x(dim);
-	for(unsigned int i=0; i<dim; i++) {
-		assert(lb(i) <= ub(i));
-		x(i) = generateRandomDouble(lb(i), ub(i));
-	}
+	fillWithRandomNumbers(x.memptr(), lb.memptr(), ub.memptr(), dim);
 	return x;
 
 }
 
 
-mat generateRandomMatrix(unsigned int Nrows, vec lb, vec ub){
+/* the matrix is filled column by column, each column has a single pair of bounds */
+mat generateRandomMatrix(unsigned int Nrows, const vec &lb, const vec &ub){
 
 	assert(lb.size() == ub.size());
 	unsigned int dim = lb.size();
 
-	mat X(Nrows, dim, fill::zeros);
+	mat X(Nrows, dim);
+
+	RandomNumberGenerator &generator = getRandomNumberGenerator();
+
+	for(unsigned int j=0; j<dim; j++) {
 
-	for(unsigned int i=0; i<Nrows; i++) {
+		assert(lb(j) <= ub(j));
 
-		X.row(i) = generateRandomRowVector(lb,ub);
+		double lowerBound = lb(j);
+		double range = ub(j) - lb(j);
+		double *column = X.colptr(j);
+
+		for(unsigned int i=0; i<Nrows; i++) {
+
+			column[i] = lowerBound + range*generator.generateUniform();
+		}
 
 	}
 
@@ -138,24 +339,18 @@ mat generateRandomMatrix(unsigned int Nrows, vec lb, vec ub){
 vec generateRandomVector(double lb, double ub, unsigned int dim){
 
 	assert(lb <= ub);
-	vec x(dim,fill::zeros);
-
-	for(unsigned int i=0; i<dim; i++) {
-
-		x(i) = generateRandomDouble(lb, ub);
-	}
+	vec x(dim);
+	generateRandomDoubleArray(x.memptr(), lb, ub, dim);
 	return x;
 
 }
 
 
-void generateRandomVector(vec lb, vec ub, unsigned int dim, double *x){
+void generateRandomVector(const vec &lb, const vec &ub, unsigned int dim, double *x){
 
-
-	for(unsigned int i=0; i<dim; i++) {
-		assert(lb(i) < ub(i));
-		x[i] = generateRandomDouble(lb(i), ub(i));
-	}
+	assert(lb.size() >= dim);
+	assert(ub.size() >= dim);
+	fillWithRandomNumbers(x, lb.memptr(), ub.memptr(), dim);
 
 }
 
@@ -171,11 +366,26 @@ double generateRandomDoubleFromNormalDist(double xs, double xe, double sigma_fac
 
 	if (sigma == 0.0) sigma=1.0;
 
-	/* construct a trivial random generator engine from a time-based seed */
-	unsigned seed = std::chrono::system_clock::now().time_since_epoch().count();
-	std::default_random_engine generator (seed);
 	std::normal_distribution<double> distribution (mu,sigma);
-	return distribution(generator);
+	return distribution(getRandomNumberGenerator());
+}
+
+/** generate a random number between a and b that depends only on seed and counter (splitmix64 hash),
+ * can be called from parallel regions and gives the same numbers for any number of threads
+ *
+ */
+double generateRandomDoubleFromCounter(unsigned long long seed, unsigned long long counter, double a, double b){
+
+	unsigned long long z = seed*0x9E3779B97F4A7C15ULL + (counter+1)*0xBF58476D1CE4E5B9ULL;
+
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	z = z ^ (z >> 31);
+
+	/* 53 random bits mapped to [0,1) */
+	double random = (z >> 11) * (1.0/9007199254740992.0);
+
+	return a + random*(b - a);
 }
 
 //void generateKRandomIntegers(uvec &numbers, unsigned int N, unsigned int k){
@@ -0,0 +1,302 @@
+/*
+ * RoDeO, a Robust Design Optimization Package
+ *
+ * Copyright (C) 2015-2021 Chair for Scientific Computing (SciComp), TU Kaiserslautern
+ * Homepage: http://www.scicomp.uni-kl.de
+ * Contact:  Prof. Nicolas R. Gauger (nicolas.gauger@scicomp.uni-kl.de) or Dr. Emre Özkaya (emre.oezkaya@scicomp.uni-kl.de)
+ *
+ * Lead developer: Emre Özkaya (SciComp, TU Kaiserslautern)
+ *
+ * This file is part of RoDeO
+ *
+ * RoDeO is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * RoDeO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * See the GNU General Public License for more details.
+ * You should have received a copy of the GNU
+ * General Public License along with CoDiPack.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authors: Emre Özkaya, (SciComp, TU Kaiserslautern)
+ *
+ *
+ *
+ */
+
+#include <cassert>
+#include <cstdint>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "simulation_worker.hpp"
+
+extern char **environ;
+
+
+SimulationWorker::SimulationWorker(){}
+
+SimulationWorker::~SimulationWorker(){
+
+	stop();
+}
+
+/** Starts the worker process
+ * @param[in] executableToRun: path of the executable, e.g. ./simulation
+ * @return false if the process could not be started or the executable could not be run
+ *
+ */
+bool SimulationWorker::start(const std::string &executableToRun){
+
+	assert(!executableToRun.empty());
+
+	std::lock_guard<std::mutex> lock(workerMutex);
+
+	if(ifRunning) return true;
+
+	executable = executableToRun;
+
+	/* all descriptors are close-on-exec, so that workers started by other threads do not inherit them */
+	int pipeRequest[2];
+	int pipeReply[2];
+	int pipeStatus[2];
+
+	if(pipe2(pipeRequest, O_CLOEXEC) != 0) return false;
+
+	if(pipe2(pipeReply, O_CLOEXEC) != 0){
+
+		close(pipeRequest[0]); close(pipeRequest[1]);
+		return false;
+	}
+
+	/* the child writes errno to this pipe if execve fails, a successful execve closes it */
+	if(pipe2(pipeStatus, O_CLOEXEC) != 0){
+
+		close(pipeRequest[0]); close(pipeRequest[1]);
+		close(pipeReply[0]);   close(pipeReply[1]);
+		return false;
+	}
+
+	/* a worker that terminates unexpectedly must not kill the optimizer with SIGPIPE */
+	signal(SIGPIPE, SIG_IGN);
+
+	/* the environment is prepared before fork, the child calls only async-signal-safe functions */
+	std::vector<std::string> environmentStrings;
+
+	for(char **variable = environ; *variable != NULL; variable++){
+
+		if(strncmp(*variable, "RODEO_WORKER_MODE=", 18) != 0) environmentStrings.push_back(*variable);
+	}
+
+	environmentStrings.push_back("RODEO_WORKER_MODE=1");
+
+	std::vector<char *> environment;
+
+	for(auto it = environmentStrings.begin(); it != environmentStrings.end(); ++it){
+
+		environment.push_back(const_cast<char *>(it->c_str()));
+	}
+
+	environment.push_back(NULL);
+
+	char *arguments[] = { const_cast<char *>(executable.c_str()), NULL };
+
+	pid_t pid = fork();
+
+	if(pid < 0){
+
+		close(pipeRequest[0]); close(pipeRequest[1]);
+		close(pipeReply[0]);   close(pipeReply[1]);
+		close(pipeStatus[0]);  close(pipeStatus[1]);
+		return false;
+	}
+
+	if(pid == 0){
+
+		/* child process: stdin <- requests, stdout -> replies. dup2 clears close-on-exec on the new descriptors */
+
+		dup2(pipeRequest[0], STDIN_FILENO);
+		dup2(pipeReply[1], STDOUT_FILENO);
+
+		close(pipeRequest[0]); close(pipeRequest[1]);
+		close(pipeReply[0]);   close(pipeReply[1]);
+		close(pipeStatus[0]);
+
+		/* the worker gets the default SIGPIPE handling, not the one of the optimizer */
+		signal(SIGPIPE, SIG_DFL);
+
+		execve(arguments[0], arguments, environment.data());
+
+		/* only reached if exec fails */
+		int errorNumber = errno;
+		ssize_t result = write(pipeStatus[1], &errorNumber, sizeof(int));
+		(void) result;
+		_exit(127);
+	}
+
+	close(pipeRequest[0]);
+	close(pipeReply[1]);
+	close(pipeStatus[1]);
+
+	/* end of file: execve has succeeded, otherwise the child has sent errno */
+	int errorNumberOfChild = 0;
+	ssize_t numberOfBytesRead;
+
+	do{
+		numberOfBytesRead = read(pipeStatus[0], &errorNumberOfChild, sizeof(int));
+
+	}while(numberOfBytesRead < 0 && errno == EINTR);
+
+	close(pipeStatus[0]);
+
+	if(numberOfBytesRead != 0){
+
+		close(pipeRequest[1]);
+		close(pipeReply[0]);
+
+		int status;
+		waitpid(pid, &status, 0);
+
+		return false;
+	}
+
+	processId = pid;
+	fileDescriptorRequest = pipeRequest[1];
+	fileDescriptorReply   = pipeReply[0];
+	ifRunning = true;
+
+	return true;
+}
+
+/* sends the termination request and waits for the worker, a worker that does not terminate within
+ * timeoutForTerminationInMilliseconds is killed */
+void SimulationWorker::stop(void){
+
+	std::lock_guard<std::mutex> lock(workerMutex);
+
+	if(!ifRunning) return;
+
+	std::vector<double> terminationRequest;
+	writeMessage(terminationRequest);
+
+	close(fileDescriptorRequest);
+	close(fileDescriptorReply);
+
+	const unsigned int pollingIntervalInMilliseconds = 10;
+	unsigned int waitingTime = 0;
+	int status;
+
+	while(waitpid(processId, &status, WNOHANG) == 0){
+
+		if(waitingTime >= timeoutForTerminationInMilliseconds){
+
+			kill(processId, SIGKILL);
+			waitpid(processId, &status, 0);
+			break;
+		}
+
+		usleep(pollingIntervalInMilliseconds*1000);
+		waitingTime += pollingIntervalInMilliseconds;
+	}
+
+	fileDescriptorRequest = -1;
+	fileDescriptorReply   = -1;
+	processId = -1;
+	ifRunning = false;
+}
+
+void SimulationWorker::setTimeoutForTermination(unsigned int milliseconds){
+
+	timeoutForTerminationInMilliseconds = milliseconds;
+}
+
+bool SimulationWorker::isRunning(void) const{
+
+	return ifRunning;
+}
+
+bool SimulationWorker::writeMessage(const std::vector<double> &values){
+
+	uint32_t size = values.size();
+
+	std::vector<char> buffer(sizeof(uint32_t) + size*sizeof(double));
+
+	memcpy(buffer.data(), &size, sizeof(uint32_t));
+
+	if(size > 0){
+
+		memcpy(buffer.data() + sizeof(uint32_t), values.data(), size*sizeof(double));
+	}
+
+	size_t numberOfBytesWritten = 0;
+
+	while(numberOfBytesWritten < buffer.size()){
+
+		ssize_t result = write(fileDescriptorRequest, buffer.data() + numberOfBytesWritten, buffer.size() - numberOfBytesWritten);
+
+		if(result <= 0) return false;
+
+		numberOfBytesWritten += result;
+	}
+
+	return true;
+}
+
+/* reads exactly one reply, false if the worker has closed the pipe */
+static bool readBytes(int fileDescriptor, char *buffer, size_t howMany){
+
+	size_t numberOfBytesRead = 0;
+
+	while(numberOfBytesRead < howMany){
+
+		ssize_t result = read(fileDescriptor, buffer + numberOfBytesRead, howMany - numberOfBytesRead);
+
+		if(result <= 0) return false;
+
+		numberOfBytesRead += result;
+	}
+
+	return true;
+}
+
+bool SimulationWorker::readMessage(std::vector<double> &values){
+
+	uint32_t size = 0;
+
+	if(!readBytes(fileDescriptorReply, reinterpret_cast<char *>(&size), sizeof(uint32_t))) return false;
+
+	values.resize(size);
+
+	if(size == 0) return true;
+
+	return readBytes(fileDescriptorReply, reinterpret_cast<char *>(values.data()), size*sizeof(double));
+}
+
+/** Sends a design to the worker and waits for the reply. Requests from different threads are serialized
+ * @param[in] input
+ * @param[out] output
+ * @return false if the worker is not running or the communication has failed
+ *
+ */
+bool SimulationWorker::evaluate(const std::vector<double> &input, std::vector<double> &output){
+
+	assert(input.size() > 0);
+
+	std::lock_guard<std::mutex> lock(workerMutex);
+
+	if(!ifRunning) return false;
+
+	if(!writeMessage(input)) return false;
+
+	return readMessage(output);
+}
@@ -186,19 +186,19 @@ unsigned int SurrogateModel::getNumberOfSamples(void) const{
 
 }
 
-mat SurrogateModel::getRawData(void) const{
+const subview<double> SurrogateModel::getRawData(void) const{
 
 	return data.getRawData();
 
 
 }
 
-mat SurrogateModel::getX(void) const{
+const subview<double> SurrogateModel::getX(void) const{
 
 	return data.getInputMatrix();
 }
 
-vec SurrogateModel::gety(void) const{
+const subview_col<double> SurrogateModel::gety(void) const{
 
 	return data.getOutputVector();
 
@@ -213,6 +213,30 @@ void SurrogateModel::readData(void){
 
 }
 
+/** Uses the training data of another model instead of reading the data file again, e.g. for the sub-models of a
+ * composite model. The sample matrices are shared, they are copied only when one of the models modifies them.
+ *
+ * @param[in] dataToShare: data that is already read (and normalized if the model requires it)
+ */
+
+void SurrogateModel::setData(const SurrogateModelData &dataToShare){
+
+	assert(dataToShare.isDataRead());
+	assert(dataToShare.ifDataHasGradients == ifHasGradientData);
+
+	data = dataToShare;
+
+	ifDataIsRead = true;
+	ifNormalized = data.isDataNormalized();
+
+}
+
+const SurrogateModelData &SurrogateModel::getData(void) const{
+
+	return data;
+
+}
+
 void SurrogateModel::printData(void) const{
 	data.print();
 }
@@ -237,6 +261,7 @@ void SurrogateModel::reduceTrainingData(const vec &lb, const vec &ub) const{
 
 	mat readBuffer;
 
+	SurrogateModelData::waitForPendingWritesToFile(filenameDataInput);
 	readBuffer.load(filenameDataInput, csv_ascii);
 	assert(N == readBuffer.n_rows);
 
@@ -313,23 +338,104 @@ void SurrogateModel::updateAuxilliaryFields(void){
 
 }
 
+/* models without hyperparameters (e.g. linear regression) ignore this option */
+void SurrogateModel::setGradientBasedTrainingOn(void){
+
+}
 
-vec SurrogateModel::interpolateVector(mat X) const{
+
+vec SurrogateModel::interpolateVector(const mat &X) const{
 
 	assert(X.max() <= 1.0/data.getDimension());
 	assert(X.min() >= 0.0);
 
-	unsigned int N = X.n_rows;
-	vec results(N);
+	vec results;
+	interpolateBatch(X, results);
 
-	for(unsigned int i=0; i<N; i++){
+	return results;
+}
+
+/** Evaluates the model (and optionally the variance) for all rows of X. Models override this method to
+ * evaluate many points at once, the default implementation calls interpolate/interpolateWithVariance for each row
+ * @param[in] X: points to evaluate (normalized), one point per row
+ * @param[out] estimates
+ * @param[out] variances: not computed if NULL
+ *
+ */
+
+void SurrogateModel::interpolateBatch(const mat &X, vec &estimates, vec *variances) const{
+
+	unsigned int numberOfPoints = X.n_rows;
+
+	estimates.set_size(numberOfPoints);
+
+	if(variances != NULL){
+
+		variances->set_size(numberOfPoints);
+	}
+
+	for(unsigned int i=0; i<numberOfPoints; i++){
 
 		rowvec xp = X.row(i);
-		results(i) = interpolate(xp);
+
+		if(variances != NULL){
+
+			double estimate = 0.0;
+			double variance = 0.0;
+			interpolateWithVariance(xp, &estimate, &variance);
+			estimates(i) = estimate;
+			(*variances)(i) = variance;
+		}
+		else{
+
+			estimates(i) = interpolate(xp);
+		}
+
+	}
+
+}
+
+
+/** Evaluates the model and the variance together with their gradients with respect to xp. Models override this method
+ * with analytic gradients, the default implementation uses central finite differences
+ * @param[in] xp: point (normalized)
+ * @param[out] f_tilde
+ * @param[out] ssqr
+ * @param[out] gradientEstimate
+ * @param[out] gradientVariance
+ *
+ */
+
+void SurrogateModel::interpolateWithGradients(rowvec xp, double *f_tilde, double *ssqr, rowvec &gradientEstimate, rowvec &gradientVariance) const{
+
+	unsigned int dim = xp.size();
+
+	interpolateWithVariance(xp, f_tilde, ssqr);
+
+	gradientEstimate.set_size(dim);
+	gradientVariance.set_size(dim);
+
+	double epsilon = 10E-7;
+
+	for(unsigned int k=0; k<dim; k++){
+
+		double estimatePlus, estimateMinus, variancePlus, varianceMinus;
+
+		double xSave = xp(k);
+
+		xp(k) = xSave + epsilon;
+		interpolateWithVariance(xp, &estimatePlus, &variancePlus);
+
+		xp(k) = xSave - epsilon;
+		interpolateWithVariance(xp, &estimateMinus, &varianceMinus);
+
+		xp(k) = xSave;
+
+		gradientEstimate(k) = (estimatePlus - estimateMinus)/(2.0*epsilon);
+		gradientVariance(k) = (variancePlus - varianceMinus)/(2.0*epsilon);
 
 	}
 
-	return results;
 }
 
 
@@ -33,22 +33,28 @@
 
 #include "surrogate_model_data.hpp"
 #include "auxiliary_functions.hpp"
+#include "binary_data_file.hpp"
+#include <future>
+#include <mutex>
+#include <map>
+#include <algorithm>
 
 
 
 
-SurrogateModelData::SurrogateModelData(){}
+SurrogateModelData::SurrogateModelData(){
 
+	samples = std::make_shared<SurrogateModelSampleMatrices>();
+}
+
+/* the other copies of the data keep the old sample matrices */
 
 void SurrogateModelData::reset(void){
 
-	X.reset();
+	samples = std::make_shared<SurrogateModelSampleMatrices>();
 	XTest.reset();
-	Xraw.reset();
 	XrawTest.reset();
 	dimension = 0;
-	gradient.reset();
-	differentiationDirections.reset();
 	directionalDerivatives.reset();
 	ifDataHasGradients = false;
 	ifDataIsNormalized = false;
@@ -92,9 +98,46 @@ bool SurrogateModelData::isDataRead(void) const{
 
 }
 
-mat SurrogateModelData::getRawData(void) const{
+bool SurrogateModelData::isDataSharedWith(const SurrogateModelData &other) const{
+
+	return samples == other.samples;
+
+}
+
+/* copy on write: the sample matrices are copied only if they are shared with another copy of the data */
 
-	return rawData;
+SurrogateModelSampleMatrices &SurrogateModelData::getSampleMatricesForModification(void){
+
+	assert(samples);
+
+	if(samples.use_count() > 1){
+
+		samples = std::make_shared<SurrogateModelSampleMatrices>(*samples);
+	}
+
+	samples->numberOfRows = numberOfSamples;
+
+	return *samples;
+}
+
+/* a new sample is written after the last row of this copy, the other copies do not see it. The sample matrices are
+ * copied only if another copy has already appended its own samples to them */
+
+SurrogateModelSampleMatrices &SurrogateModelData::getSampleMatricesForAppending(void){
+
+	assert(samples);
+
+	if(samples.use_count() > 1 && samples->numberOfRows != numberOfSamples){
+
+		samples = std::make_shared<SurrogateModelSampleMatrices>(*samples);
+	}
+
+	return *samples;
+}
+
+const subview<double> SurrogateModelData::getRawData(void) const{
+
+	return samples->rawData.head_rows(numberOfSamples);
 
 
 }
@@ -146,17 +189,30 @@ void SurrogateModelData::readData(string inputFilename){
 
 	outputToScreen.printMessage("Loading data from the file: " + inputFilename);
 
-	bool status = rawData.load(inputFilename.c_str(), csv_ascii);
+	waitForPendingWritesToFile(inputFilename);
 
-	if(status == true)
-	{
-		outputToScreen.printMessage("Data input is done...");
+	/* new storage, the copies sharing the old data are not affected */
+	samples = std::make_shared<SurrogateModelSampleMatrices>();
+	mat &rawData = samples->rawData;
 
+	if(BinaryDataFile::checkIfBinaryDataFile(inputFilename)){
+
+		readDataBinary(inputFilename);
 	}
-	else
-	{
-		outputToScreen.printErrorMessageAndAbort("Problem with data the input (cvs ascii format), cannot read: " + inputFilename);
+	else{
 
+		bool status = rawData.load(inputFilename.c_str(), csv_ascii);
+
+		if(status == true)
+		{
+			outputToScreen.printMessage("Data input is done...");
+
+		}
+		else
+		{
+			outputToScreen.printErrorMessageAndAbort("Problem with data the input (cvs ascii format), cannot read: " + inputFilename);
+
+		}
 	}
 
 	numberOfSamples = rawData.n_rows;
@@ -180,6 +236,182 @@ void SurrogateModelData::readData(string inputFilename){
 
 }
 
+/* reads the raw data from a binary data file, the flags of the file must be consistent with the data type of the model */
+
+void SurrogateModelData::readDataBinary(string inputFilename){
+
+	BinaryDataFile dataFile(inputFilename);
+
+	getSampleMatricesForModification().rawData = dataFile.read();
+
+	if(dataFile.checkIfDataHasGradients() != ifDataHasGradients ||
+			dataFile.checkIfDataHasDirectionalDerivatives() != ifDataHasDirectionalDerivatives){
+
+		outputToScreen.printErrorMessageAndAbort("Derivative data of the binary data file does not match with the surrogate model: " + inputFilename);
+	}
+
+	if(!boxConstraints.areBoundsSet() && dataFile.getBoxConstraints().areBoundsSet()){
+
+		boxConstraints = dataFile.getBoxConstraints();
+	}
+
+	outputToScreen.printMessage("Data input is done (binary data file)...");
+
+}
+
+/** Appends a new sample to the data in memory, only the new sample is normalized. The data file is not changed,
+ * see appendSampleToFileAsynchronously. The sample is written to a spare row, therefore the copies sharing the
+ * sample matrices (e.g. the sub-models of a composite model) are not copied and see the new sample after they take
+ * over this data.
+ *
+ * @param[in] newSample: raw sample, same layout as a row of the data file
+ */
+
+void SurrogateModelData::appendSample(const rowvec &newSample){
+
+	assert(ifDataIsRead);
+	assert(dimension>0);
+	assert(newSample.size() == samples->rawData.n_cols);
+
+	SurrogateModelSampleMatrices &S = getSampleMatricesForAppending();
+
+	unsigned int N = numberOfSamples;
+
+	reserveRowForTheNewSample(S.rawData);
+	S.rawData.row(N) = newSample;
+
+	rowvec x = newSample.head(dimension);
+	reserveRowForTheNewSample(S.Xraw);
+	S.Xraw.row(N) = x;
+
+	if(ifDataIsNormalized){
+
+		assert(boxConstraints.areBoundsSet());
+
+		for(unsigned int j=0; j<dimension; j++){
+
+			double xmin = boxConstraints.getLowerBound(j);
+			double xmax = boxConstraints.getUpperBound(j);
+			x(j) = (x(j) - xmin)/(xmax - xmin)/dimension;
+		}
+	}
+
+	reserveRowForTheNewSample(S.X);
+	S.X.row(N) = x;
+	appendColumnToSampleMajorMatrix(S.XSampleMajor, x);
+
+	reserveRowForTheNewSample(y);
+	y(N) = newSample(dimension)*scalingFactorOutput;
+
+	if(ifDataHasGradients){
+
+		reserveRowForTheNewSample(S.gradient);
+		S.gradient.row(N) = newSample.subvec(dimension+1, 2*dimension);
+	}
+
+	if(ifDataHasDirectionalDerivatives){
+
+		double directionalDerivative = newSample(dimension+1);
+
+		if(ifDataIsNormalized){
+
+			double scalingFactor = (boxConstraints.getUpperBound(0) - boxConstraints.getLowerBound(0))*dimension;
+			directionalDerivative = scalingFactor * directionalDerivative;
+		}
+
+		reserveRowForTheNewSample(directionalDerivatives);
+		directionalDerivatives(N) = directionalDerivative;
+
+		rowvec differentiationDirection = newSample.subvec(dimension+2, 2*dimension+1);
+		reserveRowForTheNewSample(S.differentiationDirections);
+		S.differentiationDirections.row(N) = differentiationDirection;
+		appendColumnToSampleMajorMatrix(S.differentiationDirectionsSampleMajor, differentiationDirection);
+	}
+
+	numberOfSamples++;
+	S.numberOfRows = numberOfSamples;
+
+}
+
+/* the matrices (and the output vectors) keep spare rows, so that appending a sample does not reallocate every time */
+
+void SurrogateModelData::reserveRowForTheNewSample(mat &M){
+
+	unsigned int N = numberOfSamples;
+
+	if(M.n_rows <= N){
+
+		unsigned int capacity = std::max(2*N, 16u);
+		M.resize(capacity, M.n_cols);
+	}
+
+}
+
+/* the sample-major matrices keep spare columns, so that appending a sample does not reallocate every time */
+
+void SurrogateModelData::appendColumnToSampleMajorMatrix(mat &M, const rowvec &v){
+
+	unsigned int N = numberOfSamples;
+
+	if(M.n_cols <= N){
+
+		unsigned int capacity = std::max(2*N, 16u);
+		M.resize(dimension, capacity);
+	}
+
+	M.col(N) = v.t();
+
+}
+
+/* pending writes of a data file, the writes of the same file are done one after the other */
+
+static std::mutex mutexPendingWrites;
+static std::map<std::string, std::shared_future<void> > pendingWrites;
+
+/** Appends a sample to the data file in the background, so that the model can be updated in the meantime.
+ * readData waits until the pending writes of the file are finished.
+ *
+ * @param[in] newSample
+ * @param[in] filename: data file (csv or binary)
+ */
+
+void SurrogateModelData::appendSampleToFileAsynchronously(const rowvec &newSample, string filename){
+
+	assert(isNotEmpty(filename));
+
+	std::lock_guard<std::mutex> lock(mutexPendingWrites);
+
+	std::shared_future<void> previousWrite;
+
+	auto it = pendingWrites.find(filename);
+	if(it != pendingWrites.end()) previousWrite = it->second;
+
+	pendingWrites[filename] = std::async(std::launch::async, [newSample, filename, previousWrite](){
+
+		if(previousWrite.valid()) previousWrite.wait();
+		appendRowVectorToCSVData(newSample, filename);
+
+	}).share();
+
+}
+
+void SurrogateModelData::waitForPendingWritesToFile(string filename){
+
+	std::shared_future<void> write;
+
+	{
+		std::lock_guard<std::mutex> lock(mutexPendingWrites);
+
+		auto it = pendingWrites.find(filename);
+		if(it == pendingWrites.end()) return;
+
+		write = it->second;
+	}
+
+	write.wait();
+
+}
+
 void SurrogateModelData::readDataTest(string inputFilename){
 
 	assert(isNotEmpty(inputFilename));
@@ -187,7 +419,18 @@ void SurrogateModelData::readDataTest(string inputFilename){
 
 	outputToScreen.printMessage("Loading test data from the file: " + inputFilename);
 
-	bool status = XrawTest.load(inputFilename.c_str(), csv_ascii);
+	bool status = true;
+
+	if(BinaryDataFile::checkIfBinaryDataFile(inputFilename)){
+
+		BinaryDataFile dataFile(inputFilename);
+		XrawTest = dataFile.read();
+	}
+	else{
+
+		status = XrawTest.load(inputFilename.c_str(), csv_ascii);
+	}
+
 	if(status == true)
 	{
 		outputToScreen.printMessage("Data input is done...");
@@ -222,6 +465,7 @@ void SurrogateModelData::readDataTest(string inputFilename){
 void SurrogateModelData::assignDimensionFromData(void){
 
 	unsigned int dimensionOfTrainingData;
+	const mat &rawData = samples->rawData;
 
 	if(ifDataHasGradients){
 		dimensionOfTrainingData = (rawData.n_cols-1)/2;
@@ -247,8 +491,12 @@ void SurrogateModelData::assignSampleInputMatrix(void){
 	assert(dimension>0);
 	assert(numberOfSamples>0);
 
-	X = rawData.submat(0,0,numberOfSamples-1, dimension-1);
-	Xraw = X;
+	SurrogateModelSampleMatrices &S = getSampleMatricesForModification();
+
+	S.X = S.rawData.submat(0,0,numberOfSamples-1, dimension-1);
+	S.Xraw = S.X;
+
+	updateSampleMajorMatrices();
 
 }
 
@@ -257,7 +505,7 @@ void SurrogateModelData::assignSampleOutputVector(void){
 	assert(dimension>0);
 	assert(numberOfSamples>0);
 
-	y = rawData.col(dimension);
+	y = samples->rawData.submat(0, dimension, numberOfSamples-1, dimension);
 
 }
 
@@ -269,9 +517,11 @@ void SurrogateModelData::assignGradientMatrix(void){
 
 	if(ifDataHasGradients){
 
-		assert(rawData.n_cols > dimension+1);
+		SurrogateModelSampleMatrices &S = getSampleMatricesForModification();
+
+		assert(S.rawData.n_cols > dimension+1);
 
-		gradient = rawData.submat(0, dimension+1, numberOfSamples - 1, 2*dimension);
+		S.gradient = S.rawData.submat(0, dimension+1, numberOfSamples - 1, 2*dimension);
 
 	}
 
@@ -284,7 +534,7 @@ void SurrogateModelData::assignDirectionalDerivativesVector(void){
 	assert(dimension>0);
 
 	if(ifDataHasDirectionalDerivatives){
-		directionalDerivatives = rawData.col(dimension+1);
+		directionalDerivatives = samples->rawData.submat(0, dimension+1, numberOfSamples-1, dimension+1);
 	}
 }
 
@@ -295,8 +545,22 @@ void SurrogateModelData::assignDifferentiationDirectionMatrix(void){
 	assert(numberOfSamples>0);
 
 	if(ifDataHasDirectionalDerivatives){
-		differentiationDirections = rawData.submat(0, dimension+2,numberOfSamples-1,  2*dimension+1);
+		SurrogateModelSampleMatrices &S = getSampleMatricesForModification();
+		S.differentiationDirections = S.rawData.submat(0, dimension+2,numberOfSamples-1,  2*dimension+1);
 	}
+
+	updateSampleMajorMatrices();
+}
+
+/* must be called whenever X or the differentiation directions change */
+
+void SurrogateModelData::updateSampleMajorMatrices(void){
+
+	SurrogateModelSampleMatrices &S = getSampleMatricesForModification();
+
+	S.XSampleMajor = S.X.t();
+	S.differentiationDirectionsSampleMajor = S.differentiationDirections.t();
+
 }
 
 void SurrogateModelData::normalize(void){
@@ -313,7 +577,10 @@ void SurrogateModelData::normalize(void){
 
 void SurrogateModelData::normalizeSampleInputMatrix(void){
 
-	assert(X.n_rows ==  numberOfSamples);
+	SurrogateModelSampleMatrices &S = getSampleMatricesForModification();
+	mat &X = S.X;
+
+	assert(X.n_rows >=  numberOfSamples);
 	assert(X.n_cols ==  dimension);
 	assert(boxConstraints.getDimension() == dimension);
 	assert(boxConstraints.areBoundsSet());
@@ -333,6 +600,7 @@ void SurrogateModelData::normalizeSampleInputMatrix(void){
 	}
 
 	X = (1.0/dimension)*XNormalized;
+	updateSampleMajorMatrices();
 
 	ifDataIsNormalized = true;
 }
@@ -389,6 +657,8 @@ void SurrogateModelData::normalizeGradientMatrix(void){
 		assert(ifDataIsRead);
 		assert(boxConstraints.areBoundsSet());
 
+		mat &gradient = getSampleMatricesForModification().gradient;
+
 		for(unsigned int i=0; i<dimension; i++){
 
 			vec lb = boxConstraints.getLowerBounds();
@@ -438,13 +708,15 @@ double SurrogateModelData::getScalingFactorForOutput(void) const{
 
 rowvec SurrogateModelData::getRowGradient(unsigned int index) const{
 
-	return gradient.row(index);
+	assert(index < numberOfSamples);
+	return samples->gradient.row(index);
 
 }
 
-vec SurrogateModelData::getDirectionalDerivativesVector(void) const{
+const subview_col<double> SurrogateModelData::getDirectionalDerivativesVector(void) const{
 
-	return directionalDerivatives;
+	assert(ifDataHasDirectionalDerivatives);
+	return directionalDerivatives.head(numberOfSamples);
 
 
 }
@@ -452,14 +724,16 @@ vec SurrogateModelData::getDirectionalDerivativesVector(void) const{
 
 rowvec SurrogateModelData::getRowDifferentiationDirection(unsigned int index) const{
 
-	return differentiationDirections.row(index);
+	assert(index < numberOfSamples);
+	return samples->differentiationDirections.row(index);
 
 }
 
 
 rowvec SurrogateModelData::getRowRawData(unsigned int index) const{
 
-	return rawData.row(index);
+	assert(index < numberOfSamples);
+	return samples->rawData.row(index);
 
 }
 
@@ -467,9 +741,9 @@ rowvec SurrogateModelData::getRowRawData(unsigned int index) const{
 
 rowvec SurrogateModelData::getRowX(unsigned int index) const{
 
-	assert(index < X.n_rows);
+	assert(index < numberOfSamples);
 
-	return X.row(index);
+	return samples->X.row(index);
 
 }
 
@@ -484,11 +758,47 @@ rowvec SurrogateModelData::getRowXTest(unsigned int index) const{
 
 
 
+const subview_row<double> SurrogateModelData::getRowXView(unsigned int index) const{
+
+	assert(index < numberOfSamples);
+	return samples->X.row(index);
+}
+
+const subview_row<double> SurrogateModelData::getRowXRawView(unsigned int index) const{
+
+	assert(index < numberOfSamples);
+	return samples->Xraw.row(index);
+}
+
+const subview_row<double> SurrogateModelData::getRowGradientView(unsigned int index) const{
+
+	assert(index < numberOfSamples);
+	return samples->gradient.row(index);
+}
+
+const subview_row<double> SurrogateModelData::getRowDifferentiationDirectionView(unsigned int index) const{
+
+	assert(index < numberOfSamples);
+	return samples->differentiationDirections.row(index);
+}
+
+const double *SurrogateModelData::getPointerToRowX(unsigned int index) const{
+
+	assert(index < numberOfSamples);
+	return samples->XSampleMajor.colptr(index);
+}
+
+const double *SurrogateModelData::getPointerToRowDifferentiationDirection(unsigned int index) const{
+
+	assert(index < numberOfSamples);
+	return samples->differentiationDirectionsSampleMajor.colptr(index);
+}
+
 rowvec SurrogateModelData::getRowXRaw(unsigned int index) const{
 
-	assert(index < Xraw.n_rows);
+	assert(index < numberOfSamples);
 
-	return Xraw.row(index);
+	return samples->Xraw.row(index);
 }
 
 rowvec SurrogateModelData::getRowXRawTest(unsigned int index) const{
@@ -499,9 +809,9 @@ rowvec SurrogateModelData::getRowXRawTest(unsigned int index) const{
 }
 
 
-vec SurrogateModelData::getOutputVector(void) const{
+const subview_col<double> SurrogateModelData::getOutputVector(void) const{
 
-	return y;
+	return y.head(numberOfSamples);
 
 }
 
@@ -522,26 +832,27 @@ void SurrogateModelData::setOutputVector(vec yIn){
 }
 
 
-mat SurrogateModelData::getInputMatrix(void) const{
+const subview<double> SurrogateModelData::getInputMatrix(void) const{
 
-	return X;
+	return samples->X.head_rows(numberOfSamples);
 
 }
 
 
 double SurrogateModelData::getMinimumOutputVector(void) const{
 
-	return min(y);
+	return min(getOutputVector());
 }
 
 double SurrogateModelData::getMaximumOutputVector(void) const{
 
-	return max(y);
+	return max(getOutputVector());
 }
 
-mat SurrogateModelData::getGradientMatrix(void) const{
+const subview<double> SurrogateModelData::getGradientMatrix(void) const{
 
-	return gradient;
+	assert(ifDataHasGradients);
+	return samples->gradient.head_rows(numberOfSamples);
 
 }
 
@@ -570,8 +881,8 @@ void SurrogateModelData::setBoxConstraintsFromData(void){
 
 	for(unsigned int i=0; i<dimension; i++){
 
-		minofX(i) = min(Xraw.col(i));
-		maxofX(i) = max(Xraw.col(i));
+		minofX(i) = min(samples->Xraw.col(i).head(numberOfSamples));
+		maxofX(i) = max(samples->Xraw.col(i).head(numberOfSamples));
 
 
 	}
@@ -588,7 +899,7 @@ void SurrogateModelData::setBoxConstraintsFromData(void){
 }
 
 
-Bounds SurrogateModelData::getBoxConstraints(void) const{
+const Bounds &SurrogateModelData::getBoxConstraints(void) const{
 
 	return boxConstraints;
 
@@ -605,22 +916,22 @@ bool SurrogateModelData::isDataNormalized(void) const{
 
 void SurrogateModelData::print(void) const{
 
-	printMatrix(rawData,"raw data");
-	printMatrix(X,"sample input matrix");
-	printVector(y,"sample output vector");
+	printMatrix(getRawData(),"raw data");
+	printMatrix(getInputMatrix(),"sample input matrix");
+	printVector(vec(getOutputVector()),"sample output vector");
 
 	printScalar(scalingFactorOutput);
 
 	if(ifDataHasGradients){
 
-		printMatrix(gradient,"sample gradient matrix");
+		printMatrix(getGradientMatrix(),"sample gradient matrix");
 
 	}
 
 	if(ifDataHasDirectionalDerivatives){
 
-		printVector(directionalDerivatives, "directional derivatives");
-		printMatrix(differentiationDirections, "differentiation directions");
+		printVector(vec(getDirectionalDerivativesVector()), "directional derivatives");
+		printMatrix(samples->differentiationDirections.head_rows(numberOfSamples), "differentiation directions");
 
 	}
 
@@ -34,6 +34,7 @@
 #include<fstream>
 #include<string>
 #include<cassert>
+#include<vector>
 
 
 #include "tgek.hpp"
@@ -72,6 +73,13 @@ void TGEKModel::setNumberOfTrainingIterations(unsigned int n){
 
 }
 
+/* used for the training of the auxiliary Kriging model */
+void TGEKModel::setGradientBasedTrainingOn(void){
+
+	auxiliaryModel.setGradientBasedTrainingOn();
+
+}
+
 void TGEKModel::setNumberOfDifferentiatedBasisFunctionsUsed(unsigned int n){
 
 	numberOfDifferentiatedBasisFunctions = n;
@@ -104,11 +112,6 @@ void TGEKModel::initializeSurrogateModel(void){
 
 	prepareTrainingDataForTheKrigingModel();
 
-	auxiliaryModel.setNameOfInputFile(filenameTrainingDataAuxModel);
-	auxiliaryModel.setBoxConstraints(data.getBoxConstraints());
-	auxiliaryModel.readData();
-	auxiliaryModel.normalizeData();
-	auxiliaryModel.initializeSurrogateModel();
 	auxiliaryModel.setNumberOfTrainingIterations(numberOfTrainingIterations);
 	auxiliaryModel.setNumberOfThreads(numberOfThreads);
 	auxiliaryModel.initializeSurrogateModel();
@@ -160,6 +163,14 @@ void TGEKModel::updateAuxilliaryFields(void){
 
 	auxiliaryModel.updateAuxilliaryFields();
 
+	updateWeightsOfBasisFunctions();
+
+}
+
+/* solves the weighted least squares problem for the weights of the basis functions, the hyperparameters are not changed */
+
+void TGEKModel::updateWeightsOfBasisFunctions(void){
+
 	if(numberOfDifferentiatedBasisFunctions > 0){
 
 		findIndicesOfDifferentiatedBasisFunctionLocations();
@@ -196,7 +207,7 @@ void TGEKModel::updateAuxilliaryFields(void){
 }
 
 mat TGEKModel::getWeightMatrix(void) const{
-	return weightMatrix;
+	return diagmat(weightsOfEquations);
 }
 
 vec TGEKModel::getSampleWeightsVector(void) const{
@@ -243,16 +254,9 @@ void TGEKModel::generateWeightingMatrix(void){
 
 	generateSampleWeights();
 
+	/* only the diagonal is stored, the weighting is a scaling of the equations (rows of Phi) */
 
-	unsigned int N = data.getNumberOfSamples();
-	weightMatrix = zeros<mat>(2*N, 2*N);
-
-	for(unsigned int i=0; i<N; i++){
-		weightMatrix(i,i) = sampleWeights(i);
-	}
-	for(unsigned int i=N; i<2*N; i++){
-		weightMatrix(i,i) = sampleWeights(i-N)*0.5;
-	}
+	weightsOfEquations = join_cols(sampleWeights, 0.5*sampleWeights);
 
 }
 
@@ -274,9 +278,7 @@ void TGEKModel::generateRhsForRBFs(void){
 		ydot(N+i) = derivatives(i);
 	}
 
-	/* Multiply with the weight matrix 2Nx2N * 2N */
-
-	Wydot = weightMatrix*ydot;
+	Wydot = weightsOfEquations % ydot;
 }
 
 
@@ -293,28 +295,20 @@ void TGEKModel::train(void){
 }
 
 
+/* the Kriging model is trained with the samples and the function values of the data in memory, the sample matrices
+ * are shared (no copy, no file), the directional derivatives are not used by the Kriging model */
+
 void TGEKModel::prepareTrainingDataForTheKrigingModel(void){
 
 	assert(ifDataIsRead);
-	mat rawData = data.getRawData();
-	unsigned int N = data.getNumberOfSamples();
-	unsigned int dim = data.getDimension();
 
-	mat inputX = data.getInputMatrix();
-	vec y = data.getOutputVector();
+	auxiliaryModel.setData(data);
 
-	mat trainingDataForAuxModel(N,dim+1);
-
-	for(unsigned int i=0; i<dim; i++){
-
-		trainingDataForAuxModel.col(i) = inputX.col(i);
-	}
-
-	trainingDataForAuxModel.col(dim) = y;
+}
 
-	//	trainingDataForAuxModel.print("trainingDataForAuxModel");
+const KrigingModel &TGEKModel::getAuxiliaryModel(void) const{
 
-	saveMatToCVSFile(trainingDataForAuxModel, filenameTrainingDataAuxModel);
+	return auxiliaryModel;
 
 }
 
@@ -329,8 +323,6 @@ void TGEKModel::trainTheta(void){
 	//	theta.print("theta");
 	correlationFunction.setHyperParameters(theta);
 
-	remove(filenameTrainingDataAuxModel.c_str());
-
 }
 
 double TGEKModel::interpolate(rowvec x) const{
@@ -339,19 +331,22 @@ double TGEKModel::interpolate(rowvec x) const{
 	unsigned int N = data.getNumberOfSamples();
 	unsigned int Nd = numberOfDifferentiatedBasisFunctions;
 
+	/* the basis function centers are accessed in place, no copies */
+
+	const double *xp = x.memptr();
+
 	double sum = 0.0;
 	for(unsigned int i=0; i<N; i++){
-		rowvec xi = data.getRowX(i);
-		double r = correlationFunction.computeCorrelation(xi,x);
+		double r = correlationFunction.computeCorrelation(data.getPointerToRowX(i),xp);
 		sum += w(i)*r;
 	}
 
 	for(unsigned int i=0; i<Nd; i++){
 
 		unsigned int index = indicesDifferentiatedBasisFunctions(i);
-		rowvec xi = data.getRowX(index);
-		rowvec diffDirection = data.getRowDifferentiationDirection(index);
-		sum +=w(i+N)*correlationFunction.computeCorrelationDot(xi, x, diffDirection);
+		const double *xi = data.getPointerToRowX(index);
+		const double *diffDirection = data.getPointerToRowDifferentiationDirection(index);
+		sum +=w(i+N)*correlationFunction.computeCorrelationDot(xi, xp, diffDirection);
 	}
 
 
@@ -363,6 +358,46 @@ void TGEKModel::interpolateWithVariance(rowvec xp,double *f_tilde,double *ssqr)
 	auxiliaryModel.interpolateWithVariance(xp, f_tilde, ssqr);
 	*f_tilde = interpolate(xp);
 
+}
+
+/* variances are computed in batch by the auxiliary Kriging model, the basis functions are evaluated in parallel */
+
+void TGEKModel::interpolateBatch(const mat &X, vec &estimates, vec *variances) const{
+
+	unsigned int numberOfPoints = X.n_rows;
+
+	if(variances != NULL){
+
+		vec estimatesAuxiliaryModel;
+		auxiliaryModel.interpolateBatch(X, estimatesAuxiliaryModel, variances);
+	}
+
+	unsigned int N = data.getNumberOfSamples();
+	unsigned int Nd = numberOfDifferentiatedBasisFunctions;
+
+	estimates.set_size(numberOfPoints);
+
+#pragma omp parallel for schedule(static)
+	for(unsigned int m=0; m<numberOfPoints; m++){
+
+		rowvec x = X.row(m);
+		const double *xp = x.memptr();
+
+		double sum = 0.0;
+		for(unsigned int i=0; i<N; i++){
+
+			sum += w(i)*correlationFunction.computeCorrelation(data.getPointerToRowX(i),xp);
+		}
+
+		for(unsigned int i=0; i<Nd; i++){
+
+			unsigned int index = indicesDifferentiatedBasisFunctions(i);
+			sum +=w(i+N)*correlationFunction.computeCorrelationDot(data.getPointerToRowX(index), xp, data.getPointerToRowDifferentiationDirection(index));
+		}
+
+		estimates(m) = sum + beta0;
+	}
+
 }
 //void TGEKModel::calculateExpectedImprovement(CDesignExpectedImprovement &designCalculated) const{
 //
@@ -439,24 +474,35 @@ void TGEKModel::addNewSampleToData(rowvec newsample){
 
 	unsigned int dim = data.getDimension();
 	assert(newsample.size() == 2*dim+2);
-	Bounds boxConstraints = data.getBoxConstraints();
+	const Bounds &boxConstraints = data.getBoxConstraints();
 
 	vec lb = boxConstraints.getLowerBounds();
 	vec ub = boxConstraints.getUpperBounds();
 	rowvec x = newsample.head(dim);
 	x = normalizeRowVector(x, lb, ub);
 
-	mat inputData = data.getInputMatrix();
-
-	bool flagTooClose= checkifTooCLose(x, inputData);
+	bool flagTooClose= checkifTooCLose(x, mat(data.getInputMatrix()));
 
 	if(!flagTooClose){
 
-		appendRowVectorToCSVData(newsample, filenameDataInput);
-		updateModelWithNewData();
+		/* the file is written in the background, the model is initialized again with the data in memory */
+
+		SurrogateModelData::appendSampleToFileAsynchronously(newsample, filenameDataInput);
+
+		data.appendSample(newsample);
 
-		rowvec xForKriging = newsample.head(dim+1);
-		auxiliaryModel.addNewSampleToData(xForKriging);
+		if(ifModelTrainingIsDone){
+
+			/* the hyperparameters are kept, the Kriging model and Phi are extended with the new sample */
+			auxiliaryModel.updateModelWithSharedData(data);
+			updateWeightsOfBasisFunctions();
+		}
+		else{
+
+			resetDataObjects();
+			if(!ifNormalized) normalizeData();
+			initializeSurrogateModel();
+		}
 
 	}
 
@@ -498,13 +544,6 @@ void TGEKModel::calculatePhiEntriesForFunctionValues(void) {
 		for (unsigned int j = 0; j < N; j++) {
 			Phi(i, j) = correlationFunction.computeCorrelation(j, i);
 		}
-		for (unsigned int j = 0; j < numberOfDifferentiatedBasisFunctions;
-				j++) {
-			unsigned int index = indicesDifferentiatedBasisFunctions(j);
-			rowvec d = data.getRowDifferentiationDirection(index);
-			Phi(i, N + j) = correlationFunction.computeCorrelationDot(index, i,
-					d);
-		}
 	}
 }
 
@@ -512,21 +551,80 @@ void TGEKModel::calculatePhiEntriesForDerivatives(void) {
 	unsigned int N = data.getNumberOfSamples();
 	/* last N equations are derivatives */
 	for (unsigned int i = 0; i < N; i++) {
+		rowvec d = data.getRowDifferentiationDirection(i);
 		for (unsigned int j = 0; j < N; j++) {
-			rowvec d = data.getRowDifferentiationDirection(i);
 			Phi(N + i, j) = correlationFunction.computeCorrelationDot(j, i, d);
 		}
-		for (unsigned int j = 0; j < numberOfDifferentiatedBasisFunctions;
-				j++) {
-			unsigned int index = indicesDifferentiatedBasisFunctions(j);
-			rowvec d1 = data.getRowDifferentiationDirection(index);
+	}
+}
+
+/* last Nd columns, the locations of the differentiated basis functions may change with every new sample */
+
+void TGEKModel::calculatePhiEntriesForDifferentiatedBasisFunctions(void) {
+	unsigned int N = data.getNumberOfSamples();
+	for (unsigned int j = 0; j < numberOfDifferentiatedBasisFunctions; j++) {
+		unsigned int index = indicesDifferentiatedBasisFunctions(j);
+		rowvec d1 = data.getRowDifferentiationDirection(index);
+		for (unsigned int i = 0; i < N; i++) {
 			rowvec d2 = data.getRowDifferentiationDirection(i);
+			Phi(i, N + j) = correlationFunction.computeCorrelationDot(index, i, d1);
 			Phi(N + i, N + j) = correlationFunction.computeCorrelationDotDot(
 					index, i, d1, d2);
 		}
 	}
 }
 
+/* Phi can be extended if the only change since it was calculated is a new sample at the end of the data */
+
+bool TGEKModel::checkIfPhiMatrixCanBeExtended(void) const{
+
+	unsigned int N = data.getNumberOfSamples();
+	unsigned int Nd = numberOfDifferentiatedBasisFunctions;
+
+	if(N < 2 || XPhiMatrix.n_rows != N-1) return false;
+	if(Phi.n_rows != 2*(N-1) || Phi.n_cols != N-1+Nd) return false;
+
+	vec hyperParameters = correlationFunction.getHyperParameters();
+
+	if(hyperParameters.size() != hyperParametersPhiMatrix.size()) return false;
+	if(any(hyperParameters != hyperParametersPhiMatrix)) return false;
+
+	const mat &X = data.getInputMatrix();
+
+	return !any(vectorise(X.head_rows(N-1) != XPhiMatrix));
+}
+
+/* only the row and the column of the new sample are calculated, the other entries of the basis functions are copied */
+
+void TGEKModel::extendPhiMatrixWithTheLastSample(void){
+
+	unsigned int N = data.getNumberOfSamples();
+	unsigned int M = N-1;
+	unsigned int Nd = numberOfDifferentiatedBasisFunctions;
+
+	mat PhiPrevious;
+	PhiPrevious.swap(Phi);
+
+	Phi = zeros<mat>(2*N, N + Nd);
+
+	Phi.submat(0, 0, M-1, M-1) = PhiPrevious.submat(0, 0, M-1, M-1);
+	Phi.submat(N, 0, N+M-1, M-1) = PhiPrevious.submat(M, 0, 2*M-1, M-1);
+
+	rowvec dNew = data.getRowDifferentiationDirection(M);
+
+	for (unsigned int j = 0; j < N; j++) {
+		Phi(M, j) = correlationFunction.computeCorrelation(j, M);
+		Phi(N + M, j) = correlationFunction.computeCorrelationDot(j, M, dNew);
+	}
+
+	for (unsigned int i = 0; i < M; i++) {
+		rowvec d = data.getRowDifferentiationDirection(i);
+		Phi(i, M) = correlationFunction.computeCorrelation(M, i);
+		Phi(N + i, M) = correlationFunction.computeCorrelationDot(M, i, d);
+	}
+
+}
+
 /*
  *
  *
@@ -547,17 +645,29 @@ void TGEKModel::calculatePhiMatrix(void){
 
 	unsigned int N = data.getNumberOfSamples();
 
-	Phi = zeros<mat>(2*N, N + numberOfDifferentiatedBasisFunctions);
+	if(checkIfPhiMatrixCanBeExtended()){
 
-	/* first N equations are functional values */
-	calculatePhiEntriesForFunctionValues();
+		extendPhiMatrixWithTheLastSample();
+	}
+	else{
 
-	/* last N equations are derivatives */
-	calculatePhiEntriesForDerivatives();
+		Phi = zeros<mat>(2*N, N + numberOfDifferentiatedBasisFunctions);
+
+		/* first N equations are functional values */
+		calculatePhiEntriesForFunctionValues();
+
+		/* last N equations are derivatives */
+		calculatePhiEntriesForDerivatives();
+	}
+
+	calculatePhiEntriesForDifferentiatedBasisFunctions();
+
+	XPhiMatrix = data.getInputMatrix();
+	hyperParametersPhiMatrix = correlationFunction.getHyperParameters();
 
-	/* multiply with the weight matrix */
+	/* multiply with the weight matrix, i.e. scale the rows */
 
-	WPhi = weightMatrix*Phi;
+	WPhi = Phi.each_col() % weightsOfEquations;
 
 }
 